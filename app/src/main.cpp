@@ -5,6 +5,7 @@ using namespace nit;
 ListenerAction on_run();
 ListenerAction game_start();
 ListenerAction game_update();
+void           move_update();
 
 int main(int argc, char** argv)
 {
@@ -20,6 +21,7 @@ constexpr Vector2 RECT_LEFT  = { -100.f, 100.f };
 constexpr Vector2 RECT_RIGHT = { 100.f, -100.f };
 constexpr float MIN_SPEED = 1.f;
 constexpr float MAX_SPEED = 15.f;
+constexpr u32   MOVE_GRAIN = 1024;
 
 // -----------------------------------------------------------------
 
@@ -30,7 +32,8 @@ struct Move
     Vector2 destination;
 };
 
-AssetHandle test_texture;
+AssetHandle    test_texture;
+EntityTemplate spawn_template;
 
 // -----------------------------------------------------------------
 
@@ -43,16 +46,15 @@ void reset_movement(Transform& transform, Move& move)
 
 // -----------------------------------------------------------------
 
-void spawn_entity()
+void spawn_entities(u32 count)
 {
-    Entity entity = CreateEntity();
-    Vector3 position = ToVector3(RandomPointInSquare(RECT_LEFT.x, RECT_RIGHT.y, RECT_RIGHT.x, RECT_LEFT.y)); 
-    entity_add<Transform>(entity).position = position;
-    //add<Transform>(entity).position = V3_ZERO;
-    entity_add<Sprite>(entity).tint = GetRandomColor();
-    //get<Sprite>(entity).texture = test_texture;
-    SetSpriteSubTexture2D(entity_get<Sprite>(entity), "cpp");
-    reset_movement(entity_get<Transform>(entity), entity_add<Move>(entity));
+    for (Entity entity : entity_create_many(count, spawn_template))
+    {
+        Transform& transform = entity_get<Transform>(entity);
+        transform.position = ToVector3(RandomPointInSquare(RECT_LEFT.x, RECT_RIGHT.y, RECT_RIGHT.x, RECT_LEFT.y));
+        entity_get<Sprite>(entity).tint = GetRandomColor();
+        reset_movement(transform, entity_get<Move>(entity));
+    }
 }
 
 // -----------------------------------------------------------------
@@ -64,7 +66,15 @@ ListenerAction on_run()
     engine_event(Stage::Update) += EngineListener::create(game_update);
 
     RegisterComponentType<Move>();
-    entity_create_group<Transform, Sprite, Move>();
+    entity_create_owning_group<Transform, Sprite, Move>();
+    engine_add_system<Group<Transform, Sprite, Move>, Write<Transform, Move>>(Stage::Update, "move", move_update);
+
+    Sprite sprite;
+    sprite.sub_texture = "cpp";
+    entity_template_set<Transform>(spawn_template);
+    entity_template_set<WorldTransform>(spawn_template);
+    entity_template_set<Sprite>(spawn_template, sprite);
+    entity_template_set<Move>(spawn_template);
 
     return ListenerAction::StayListening;
 }
@@ -77,7 +87,7 @@ ListenerAction game_start()
 
     if (asset_valid(test_scene))
     {
-        asset_load(test_scene);
+        scene_load_async(test_scene);
     }
 
     test_texture = asset_find_by_name("test_sheet");
@@ -87,24 +97,33 @@ ListenerAction game_start()
 
 ListenerAction game_update()
 {
-    spawn_entity();
-    
-    for (Entity entity : entity_get_group<Transform, Sprite, Move>().entities)
-    {
-        auto& transform = entity_get<Transform>(entity);
-        auto& move      = entity_get<Move>(entity);
+    spawn_entities(1);
+    return ListenerAction::StayListening;
+}
 
-        if (Distance(ToVector2(transform.position), move.destination) < 0.1f)
-        {
-            reset_movement(transform, move);
-        }
-        else
+void move_update()
+{
+    EntityGroup& group      = entity_get_group<Transform, Sprite, Move>();
+    Transform*   transforms = entity_group_patch<Transform>(group);
+    Move*        moves      = entity_group_data<Move>(group);
+    f32          delta      = delta_seconds();
+    
+    job_parallel_for((u32) group.entities.size(), MOVE_GRAIN, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
         {
-            transform.position += ToVector3(move.velocity * delta_seconds());
+            auto& transform = transforms[i];
+            auto& move      = moves[i];
+
+            if (Distance(ToVector2(transform.position), move.destination) < 0.1f)
+            {
+                reset_movement(transform, move);
+            }
+            else
+            {
+                transform.position += ToVector3(move.velocity * delta);
+            }
         }
-    }
-
-    return ListenerAction::StayListening;
+    });
 }
 
 /*
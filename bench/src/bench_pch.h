@@ -0,0 +1,5 @@
+#pragma once
+#include "nit_pch.h"
+#include "nit.h"
+
+using namespace nit;
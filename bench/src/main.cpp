@@ -0,0 +1,356 @@
+#include "nit.h"
+
+// Stress test and scaling benchmark of the job system. Run as "bench stress", "bench scale [entities] [max threads]"
+// or without arguments for both. The stress test returns non zero when a check fails.
+
+#define BENCH_CHECK(_CONDITION) if (!(_CONDITION)) { printf("FAILED %s (%s:%d)\n", #_CONDITION, __FILE__, __LINE__); return false; }
+
+constexpr u32 SCALE_ENTITIES = 200000;
+constexpr u32 SCALE_FRAMES   = 50;
+constexpr u32 MOVE_GRAIN     = 1024;
+constexpr u32 VERTEX_GRAIN   = 1024;
+
+// Same as the app's.
+struct Move
+{
+    Vector2 velocity;
+    Vector2 destination;
+};
+
+struct Position
+{
+    f32 x = 0.f;
+    f32 y = 0.f;
+};
+
+struct Velocity
+{
+    f32 x = 1.f;
+    f32 y = 2.f;
+};
+
+void registry_begin(TypeRegistry& type_registry, EntityRegistry& entity_registry, EntityStorage storage)
+{
+    type_registry_set_instance(&type_registry);
+    type_registry_init();
+    entity_registry.storage      = storage;
+    entity_registry.max_entities = 500000;
+    entity_registry_set_instance(&entity_registry);
+    entity_registry_init();
+}
+
+// -----------------------------------------------------------------
+
+struct ChainData
+{
+    std::atomic<u32>  stage = 0;
+    std::atomic<bool> open  = false;
+    std::atomic<bool> wrong = false;
+};
+
+bool stress_jobs(u32 workers)
+{
+    JobSystem job_system_instance;
+    job_system_instance.worker_count = workers;
+    job_system_set_instance(&job_system_instance);
+    job_system_init();
+
+    for (u32 round = 0; round < 200; ++round)
+    {
+        u32 count = 1 + (round * 7919) % 100000;
+        std::atomic<u64> sum = 0;
+        job_parallel_for(count, 1 + round % 300, [&](u32 begin, u32 end) {
+            u64 partial = 0;
+            for (u32 i = begin; i < end; ++i)
+            {
+                partial += i;
+            }
+            sum += partial;
+        });
+        BENCH_CHECK(sum == (u64) count * (count - 1) / 2);
+
+        std::atomic<u32> nested = 0;
+        job_parallel_for(64, 1, [&](u32, u32) {
+            job_parallel_for(100, 7, [&](u32 begin, u32 end) { nested += end - begin; });
+        });
+        BENCH_CHECK(nested == 6400);
+
+        // The first job holds the counter until every job of the chain is queued.
+        ChainData  chain;
+        JobCounter first, second, third;
+        job_run({ [](void* data, u32, u32) { while (!static_cast<ChainData*>(data)->open) { std::this_thread::yield(); } }, &chain, 0, 1, &first });
+
+        for (u32 i = 0; i < 16; ++i)
+        {
+            job_run({ [](void* data, u32, u32) {
+                auto* chain = static_cast<ChainData*>(data);
+                if (chain->stage > 1) { chain->wrong = true; }
+                chain->stage.fetch_or(1);
+            }, &chain, 0, 1, &first });
+        }
+
+        job_run_after(first, { [](void* data, u32, u32) {
+            auto* chain = static_cast<ChainData*>(data);
+            if (chain->stage != 1) { chain->wrong = true; }
+            chain->stage = 2;
+        }, &chain, 0, 1, &second });
+
+        job_run_after(second, { [](void* data, u32, u32) {
+            auto* chain = static_cast<ChainData*>(data);
+            if (chain->stage != 2) { chain->wrong = true; }
+            chain->stage = 3;
+        }, &chain, 0, 1, &third });
+
+        chain.open = true;
+        job_wait(third);
+        BENCH_CHECK(!chain.wrong && chain.stage == 3 && first.pending == 0 && second.pending == 0);
+    }
+
+    // Threads outside the pool share a queue.
+    std::atomic<u32>   total = 0;
+    Array<std::thread> threads;
+    for (u32 i = 0; i < 3; ++i)
+    {
+        threads.emplace_back([&total] {
+            for (u32 k = 0; k < 200; ++k)
+            {
+                job_parallel_for(1000, 10, [&total](u32 begin, u32 end) { total += end - begin; });
+            }
+        });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    BENCH_CHECK(total == 600000);
+
+    job_system_finish();
+    return true;
+}
+
+bool stress_entities(EntityStorage storage)
+{
+    JobSystem job_system_instance;
+    job_system_instance.worker_count = 3;
+    job_system_set_instance(&job_system_instance);
+    job_system_init();
+
+    TypeRegistry   type_registry;
+    EntityRegistry entity_registry;
+    registry_begin(type_registry, entity_registry, storage);
+    RegisterComponentType<Position>();
+    RegisterComponentType<Velocity>();
+
+    EntityTemplate moving;
+    entity_template_set<Position>(moving);
+    entity_template_set<Velocity>(moving);
+    EntityTemplate still;
+    entity_template_set<Position>(still);
+    entity_create_many(50000, moving);
+    entity_create_many(7000, still);
+    entity_create_many(30000, moving);
+
+    auto view = entity_view<Position, const Velocity>();
+    std::atomic<u32> visited = 0;
+    entity_view_parallel_each(view, 1000, [&visited](Entity, Position& position, const Velocity& velocity) {
+        position.x += velocity.x;
+        position.y += velocity.y;
+        ++visited;
+    });
+    BENCH_CHECK(visited == 80000);
+
+    u32 moved = 0;
+    entity_view_each(view, [&moved](Entity, Position& position, const Velocity&) { moved += position.x == 1.f && position.y == 2.f; });
+    BENCH_CHECK(moved == 80000);
+
+    entity_create_group<Position>();
+    EntityGroup& group = entity_get_group<Position>();
+    std::atomic<u32> patched = 0;
+    entity_parallel_for({ group.entities.data(), group.entities.size() }, 512, [&patched](Entity entity) {
+        entity_patch<Position>(entity).x += 10.f;
+        ++patched;
+    });
+    BENCH_CHECK(patched == 87000);
+
+    entity_template_release(moving);
+    entity_template_release(still);
+    FinishEntityRegistry();
+    job_system_finish();
+    return true;
+}
+
+bool stress()
+{
+    for (u32 workers : { 1u, 2u, 3u, 7u })
+    {
+        if (!stress_jobs(workers))
+        {
+            return false;
+        }
+        printf("stress jobs with %u workers OK\n", workers);
+    }
+
+    for (EntityStorage storage : { EntityStorage::Pools, EntityStorage::Archetypes })
+    {
+        if (!stress_entities(storage))
+        {
+            return false;
+        }
+        printf("stress entities on %s OK\n", storage == EntityStorage::Pools ? "pools" : "archetypes");
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------
+
+void move_update(EntityGroup& group, f32 delta)
+{
+    Transform* transforms = entity_group_patch<Transform>(group);
+    Move*      moves      = entity_group_data<Move>(group);
+
+    job_parallel_for((u32) group.entities.size(), MOVE_GRAIN, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            Transform& transform = transforms[i];
+            Move&      move      = moves[i];
+
+            if (Distance(ToVector2(transform.position), move.destination) < 0.1f)
+            {
+                move.destination = move.destination * -1.f;
+                move.velocity    = move.velocity * -1.f;
+            }
+            else
+            {
+                transform.position += ToVector3(move.velocity * delta);
+            }
+        }
+    });
+}
+
+// The per sprite part of the draw system's vertex generation, without the texture lookups and the batch submission.
+void vertex_update(EntityGroup& group, Array<V4Verts2D>& positions, Array<V4Verts2D>& colors, Array<V2Verts2D>& uvs)
+{
+    const Transform* transforms = entity_group_data<const Transform>(group);
+    const Sprite*    sprites    = entity_group_data<const Sprite>(group);
+
+    job_parallel_for((u32) group.entities.size(), VERTEX_GRAIN, [&](u32 begin, u32 end) {
+        for (u32 i = begin; i < end; ++i)
+        {
+            const Sprite& sprite = sprites[i];
+
+            uvs[i] = DEFAULT_VERTEX_U_VS_2D;
+            fill_quad_vertex_u_vs(uvs[i], sprite.flip_x, sprite.flip_y, sprite.tiling_factor);
+
+            if (sprite.keep_aspect)
+            {
+                fill_quad_vertex_positions(sprite.size, positions[i]);
+            }
+            else
+            {
+                positions[i] = DEFAULT_VERTEX_POSITIONS_2D;
+            }
+
+            transform_vertex_positions(positions[i], ToMatrix4(transforms[i]));
+            fill_vertex_colors(colors[i], sprite.tint);
+        }
+    });
+}
+
+void scale(u32 entity_count, u32 max_threads)
+{
+    TypeRegistry   type_registry;
+    EntityRegistry entity_registry;
+    registry_begin(type_registry, entity_registry, EntityStorage::Pools);
+    register_transform_component();
+    register_sprite_component();
+    RegisterComponentType<Move>();
+    entity_create_owning_group<Transform, Sprite, Move>();
+
+    EntityTemplate spawn_template;
+    entity_template_set<Transform>(spawn_template);
+    entity_template_set<Sprite>(spawn_template);
+    entity_template_set<Move>(spawn_template);
+
+    for (Entity entity : entity_create_many(entity_count, spawn_template))
+    {
+        Transform& transform = entity_get<Transform>(entity);
+        Move&      move      = entity_get<Move>(entity);
+        transform.position   = ToVector3(RandomPointInSquare(-100.f, -100.f, 100.f, 100.f));
+        transform.rotation   = { 0.f, 0.f, GetRandomValue(0.f, 360.f) };
+        move.destination     = RandomPointInSquare(-100.f, -100.f, 100.f, 100.f);
+        move.velocity        = Normalize(move.destination - ToVector2(transform.position)) * GetRandomValue(1.f, 15.f);
+        entity_get<Sprite>(entity).tint = GetRandomColor();
+    }
+
+    EntityGroup&     group = entity_get_group<Transform, Sprite, Move>();
+    Array<V4Verts2D> positions(group.entities.size());
+    Array<V4Verts2D> colors(group.entities.size());
+    Array<V2Verts2D> uvs(group.entities.size());
+
+    printf("%u entities, %u frames, %u hardware threads\n", entity_count, SCALE_FRAMES, std::thread::hardware_concurrency());
+    printf("threads   move (ms/frame)   vertices (ms/frame)\n");
+
+    for (u32 threads = 1; threads <= max_threads; ++threads)
+    {
+        JobSystem job_system_instance;
+        job_system_instance.worker_count = threads - 1;
+        job_system_set_instance(&job_system_instance);
+
+        // No workers means no job system, worker_count 0 would start one per hardware thread.
+        if (threads > 1)
+        {
+            job_system_init();
+        }
+
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point start = Clock::now();
+        for (u32 frame = 0; frame < SCALE_FRAMES; ++frame)
+        {
+            move_update(group, 1.f / 60.f);
+        }
+
+        Clock::time_point middle = Clock::now();
+        for (u32 frame = 0; frame < SCALE_FRAMES; ++frame)
+        {
+            vertex_update(group, positions, colors, uvs);
+        }
+
+        Clock::time_point end = Clock::now();
+        f64 move_ms   = std::chrono::duration<f64, std::milli>(middle - start).count() / SCALE_FRAMES;
+        f64 vertex_ms = std::chrono::duration<f64, std::milli>(end - middle).count() / SCALE_FRAMES;
+        printf("%7u   %15.2f   %19.2f\n", threads, move_ms, vertex_ms);
+
+        if (threads > 1)
+        {
+            job_system_finish();
+        }
+    }
+
+    entity_template_release(spawn_template);
+    FinishEntityRegistry();
+}
+
+// -----------------------------------------------------------------
+
+int main(int argc, char** argv)
+{
+    String mode = argc > 1 ? argv[1] : "";
+
+    if (mode.empty() || mode == "stress")
+    {
+        if (!stress())
+        {
+            return 1;
+        }
+    }
+
+    if (mode.empty() || mode == "scale")
+    {
+        u32 entity_count = argc > 2 ? (u32) std::stoul(argv[2]) : SCALE_ENTITIES;
+        u32 max_threads  = argc > 3 ? (u32) std::stoul(argv[3]) : std::max(std::thread::hardware_concurrency(), 1u);
+        scale(entity_count, max_threads);
+    }
+
+    return 0;
+}
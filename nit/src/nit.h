@@ -12,7 +12,10 @@
 #include "nit/logic/entity.h"
 #include "nit/logic/draw_system.h"
 #include "nit/logic/components.h"
+#include "nit/logic/transform_system.h"
+#include "nit/logic/spatial_system.h"
 #include "nit/logic/scene.h"
+#include "nit/logic/prefab.h"
 
 #include "nit/audio/audio_clip.h"
 #include "nit/audio/audio.h"
\ No newline at end of file
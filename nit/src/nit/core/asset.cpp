@@ -141,13 +141,22 @@ namespace nit
             asset_build_path(asset_info.name, asset_info.path);
         }
         
+        // The data pool grows on demand, keep the infos in sync with its capacity.
+        if (index >= pool->asset_infos.size())
+        {
+            pool->asset_infos.resize(pool->data_pool.sparse_set.max);
+        }
+        
         pool->asset_infos[index] = asset_info;
     }
     
     void asset_erase_info(AssetInfo& asset_info, SparseSetDeletion deletion)
     {
         AssetPool* pool = asset_get_pool_safe(asset_info);
-        pool->asset_infos[deletion.deleted_slot] = pool->asset_infos[deletion.last_slot];
+        if (deletion.deleted_slot != deletion.last_slot)
+        {
+            pool->asset_infos[deletion.deleted_slot] = std::move(pool->asset_infos[deletion.last_slot]);
+        }
     }
 
     AssetInfo* asset_get_info(AssetHandle& asset)
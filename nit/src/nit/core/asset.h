@@ -52,9 +52,9 @@ namespace nit
 
     struct AssetPool
     {
-        Pool         data_pool;
-        u32          version       = 0;
-        AssetInfo*   asset_infos   = nullptr;
+        Pool             data_pool;
+        u32              version     = 0;
+        Array<AssetInfo> asset_infos = {};
     };
     
     struct AssetRegistry
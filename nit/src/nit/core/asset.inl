@@ -23,7 +23,7 @@ namespace nit
         set_draw_editor_function  (type,  args.fn_draw_editor);
 #endif
         pool_load<T>(&asset_pool->data_pool, args.max_elements);
-        asset_pool->asset_infos = new AssetInfo[args.max_elements];
+        asset_pool->asset_infos.resize(args.max_elements);
     }
     
     template<typename T>
@@ -53,7 +53,7 @@ NIT_PRINT("\x1B[91m"); NIT_PRINTLN(__VA_ARGS__); NIT_PRINT("\033[0m")
 #define NIT_IF_EDITOR_ENABLED(_LINE) _LINE
 #define NIT_IMGUI_ENABLED
 #else
-#define NIT_EXECUTE_IF_EDITOR(_LINE)
+#define NIT_IF_EDITOR_ENABLED(_LINE)
 #endif
 
 #ifdef NIT_DEBUG
@@ -95,6 +95,7 @@ namespace nit
     using f32 = float;
     using f64 = double;
 
+    inline constexpr u16 U16_MAX = std::numeric_limits<u16>::max();
     inline constexpr u32 U32_MAX = std::numeric_limits<u32>::max();
     inline constexpr f32 F32_MAX = std::numeric_limits<f32>::max();
     inline constexpr f32 F32_EPSILON = std::numeric_limits<f32>::epsilon();
@@ -110,6 +111,9 @@ namespace nit
     template<typename T>
     using Array = std::vector<T>;
 
+    template<typename T>
+    using Span = std::span<T>;
+
     template<typename T>
     using UnorderedSet = std::unordered_set<T>;
 
@@ -5,7 +5,10 @@
 #include "render/texture.h"
 #include "logic/components.h"
 #include "logic/draw_system.h"
+#include "logic/transform_system.h"
+#include "logic/spatial_system.h"
 #include "logic/scene.h"
+#include "logic/prefab.h"
 #include "render/render_api.h"
 
 #define NIT_CHECK_ENGINE_CREATED NIT_CHECK_MSG(nit::engine, "Forget to call SetAppInstance!");
@@ -37,11 +40,127 @@ namespace nit
         return engine->events[(u8) stage];
     }
 
+    void engine_add_system(Stage stage, const System& system)
+    {
+        NIT_CHECK_ENGINE_CREATED
+        NIT_CHECK_MSG(system.function, "Invalid system!");
+        SystemSchedule& schedule = engine->schedules[(u8) stage];
+        NIT_CHECK_MSG(!schedule.done, "Can't add systems while the stage runs!");
+        schedule.systems.push_back(system);
+        schedule.dirty = true;
+    }
+
+    void engine_remove_system(Stage stage, SystemFunction function)
+    {
+        NIT_CHECK_ENGINE_CREATED
+        SystemSchedule& schedule = engine->schedules[(u8) stage];
+        NIT_CHECK_MSG(!schedule.done, "Can't remove systems while the stage runs!");
+        auto it = std::find_if(schedule.systems.begin(), schedule.systems.end(), [function](const System& system) { return system.function == function; });
+        
+        if (it != schedule.systems.end())
+        {
+            schedule.systems.erase(it);
+            schedule.dirty = true;
+        }
+    }
+
+    // A system depends on every earlier system it conflicts with, which keeps the registration order between them.
+    static void system_schedule_build(SystemSchedule& schedule)
+    {
+        u32 count = (u32) schedule.systems.size();
+        schedule.dependents.assign(count, {});
+        schedule.dependency_count.assign(count, 0);
+        schedule.waiting = Array<std::atomic<u32>>(count);
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            for (u32 j = i + 1; j < count; ++j)
+            {
+                if (entity_access_conflicts(schedule.systems[i].access, schedule.systems[j].access))
+                {
+                    schedule.dependents[i].push_back(j);
+                    ++schedule.dependency_count[j];
+                }
+            }
+        }
+
+        schedule.dirty = false;
+    }
+
+    static void system_job(void* data, u32 index, u32)
+    {
+        SystemSchedule& schedule = *static_cast<SystemSchedule*>(data);
+        const System& system = schedule.systems[index];
+        
+        EntityRegistry*     previous_registry = entity_registry_set_current(schedule.registry);
+        const EntityAccess* previous_access   = entity_access_set(&system.access);
+        system.function();
+        entity_access_set(previous_access);
+        entity_registry_set_current(previous_registry);
+
+        for (u32 dependent : schedule.dependents[index])
+        {
+            if (schedule.waiting[dependent].fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                job_run({ system_job, data, dependent, dependent + 1, schedule.done });
+            }
+        }
+    }
+
+    static void engine_run_systems(Stage stage)
+    {
+        SystemSchedule& schedule = engine->schedules[(u8) stage];
+        
+        if (schedule.systems.empty())
+        {
+            return;
+        }
+
+        if (schedule.dirty)
+        {
+            system_schedule_build(schedule);
+        }
+
+        for (u32 i = 0; i < schedule.systems.size(); ++i)
+        {
+            schedule.waiting[i].store(schedule.dependency_count[i], std::memory_order_relaxed);
+        }
+
+        JobCounter done;
+        schedule.done     = &done;
+        schedule.registry = entity_registry_get_instance();
+        
+        for (u32 i = 0; i < schedule.systems.size(); ++i)
+        {
+            if (schedule.dependency_count[i] == 0)
+            {
+                job_run({ system_job, &schedule, i, i + 1, &done });
+            }
+        }
+
+        job_wait(done);
+        schedule.done     = nullptr;
+        schedule.registry = nullptr;
+    }
+
+    // Structural changes recorded during a stage are applied once all its listeners and systems ran, then the
+    // deferred component events of the stage are delivered.
+    static void engine_broadcast(Stage stage)
+    {
+        event_broadcast(engine_event(stage));
+        engine_run_systems(stage);
+        entity_command_buffer_playback(entity_commands());
+        entity_flush_deferred_events();
+    }
+
     void engine_run()
     {
         NIT_CHECK_ENGINE_CREATED
         NIT_LOG_TRACE("Creating application...");
         
+        job_system_set_instance(&engine->job_system);
+        job_system_init();
+        
         window_set_instance(&engine->window);
         window_init();
         
@@ -71,6 +190,8 @@ namespace nit
 
         NIT_IF_EDITOR_ENABLED(register_editor());
         
+        register_transform_system();
+        register_spatial_system();
         register_draw_system();
         
         asset_registry_set_instance(&engine->asset_registry);
@@ -78,9 +199,10 @@ namespace nit
         register_texture_2d_asset();
         register_font_asset();
         register_scene_asset();
+        register_prefab_asset();
         register_clip_asset();
         
-        event_broadcast(engine_event(Stage::Run));
+        engine_broadcast(Stage::Run);
         
         asset_registry_init();
 
@@ -98,7 +220,7 @@ namespace nit
         
         NIT_LOG_TRACE("Application created!");
         
-        event_broadcast(engine_event(Stage::Start));
+        engine_broadcast(Stage::Start);
         
         while(!window_should_close())
         {
@@ -109,26 +231,26 @@ namespace nit
             engine->seconds += time_between_frames;
             engine->delta_seconds = (f32) Clamp(time_between_frames, 0., engine->max_delta_time);
 
-            event_broadcast(engine_event(Stage::Update));
+            engine_broadcast(Stage::Update);
 
             engine->acc_fixed_delta += engine->delta_seconds;
             
             while (engine->acc_fixed_delta >= engine->fixed_delta_seconds)
             {
-                event_broadcast(engine_event(Stage::FixedUpdate));
+                engine_broadcast(Stage::FixedUpdate);
                 engine->acc_fixed_delta -= engine->fixed_delta_seconds;
             }
             
-            event_broadcast(engine_event(Stage::LateUpdate));
+            engine_broadcast(Stage::LateUpdate);
 
             clear_screen();
             
             NIT_IF_EDITOR_ENABLED(im_gui_begin());
             NIT_IF_EDITOR_ENABLED(editor_begin());
             
-            event_broadcast(engine_event(Stage::PreDraw));
-            event_broadcast(engine_event(Stage::Draw));
-            event_broadcast(engine_event(Stage::PostDraw));
+            engine_broadcast(Stage::PreDraw);
+            engine_broadcast(Stage::Draw);
+            engine_broadcast(Stage::PostDraw);
 
             NIT_IF_EDITOR_ENABLED(editor_end());
             NIT_IF_EDITOR_ENABLED(im_gui_end(window_get_size()));
@@ -136,6 +258,7 @@ namespace nit
             window_update();
         }
 
-        event_broadcast(engine_event(Stage::End));
+        engine_broadcast(Stage::End);
+        job_system_finish();
     }
 }
\ No newline at end of file
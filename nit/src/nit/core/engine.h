@@ -37,10 +37,54 @@ namespace nit
     using EngineEvent    = Event<>;
     using EngineListener = Listener<>;
 
+    // Access declared by a system, e.g. engine_add_system<Read<Transform>, Write<Move>>.
+    template<typename... T>
+    struct Read
+    {
+        static void declare(EntityAccess& access) { (access.read.set(get_componentTypeIndex<T>()), ...); }
+    };
+
+    template<typename... T>
+    struct Write
+    {
+        static void declare(EntityAccess& access) { (access.write.set(get_componentTypeIndex<T>()), ...); }
+    };
+
+    // Group the system iterates. It's created when the system is added, since systems can't create groups while they
+    // run in parallel. Its components still have to be declared with Read or Write if the system touches them.
+    template<typename... T>
+    struct Group
+    {
+        static void declare(EntityAccess&) { entity_create_group<T...>(); }
+    };
+
+    using SystemFunction = void (*)();
+
+    struct System
+    {
+        SystemFunction function = nullptr;
+        EntityAccess   access;
+    };
+
+    // Systems of a stage run after its listeners. Each one waits for the earlier systems it conflicts with, the rest
+    // run in parallel on the job system.
+    struct SystemSchedule
+    {
+        Array<System>           systems;
+        Array<Array<u32>>       dependents;
+        Array<u32>              dependency_count;
+        Array<std::atomic<u32>> waiting;
+        JobCounter*             done     = nullptr;
+        EntityRegistry*         registry = nullptr; // The caller's, the systems run on it whatever thread picks them
+        bool                    dirty    = false;
+    };
+
     struct Engine
     {
         EngineEvent    events[(u8) Stage::Count];
+        SystemSchedule schedules[(u8) Stage::Count];
         
+        JobSystem      job_system;
         Window         window;
         TypeRegistry   type_registry;
         RenderObjects  render_objects;
@@ -66,5 +110,20 @@ namespace nit
     Engine*      engine_get_instance();
     f32          delta_seconds();
     EngineEvent& engine_event(Stage stage);
+    
+    // Components have to be registered before adding the systems that use them.
+    void         engine_add_system(Stage stage, const System& system);
+    void         engine_remove_system(Stage stage, SystemFunction function);
+
+    template<typename... Access>
+    void engine_add_system(Stage stage, const char* name, SystemFunction function)
+    {
+        System system;
+        system.function    = function;
+        system.access.name = name;
+        (Access::declare(system.access), ...);
+        engine_add_system(stage, system);
+    }
+    
     void         engine_run();
 }
@@ -77,16 +77,29 @@ namespace nit
     template<typename... Args>
     using Listener = Delegate<ListenerAction(Args...)>; 
     
+    template<typename... Args>
+    struct EventSlot
+    {
+        Listener<Args...> listener;
+        i32               priority = 0;
+    };
+
+    // Listeners run by descending priority, then in the order they were added. Stopped and removed listeners are
+    // cleared in place while broadcasting and compacted when the outermost broadcast ends. Listeners added meanwhile
+    // wait in pending and join after that, so a broadcast never allocates unless the listeners change.
     template<typename... Args>
     struct Event
     {
-        Array<Listener<Args...>> listeners;
+        Array<EventSlot<Args...>> listeners;
+        Array<EventSlot<Args...>> pending;
+        u32                       cleared_count   = 0;
+        u32                       broadcast_depth = 0;
     };
 
     template<typename... Args>
     bool event_empty(const Event<Args...>& event)
     {
-        return event.listeners.empty();
+        return event.listeners.size() == event.cleared_count && event.pending.empty();
     }
     
     template<typename... Args>
@@ -94,16 +107,31 @@ namespace nit
     {
         return event_empty(event);
     }
+
+    template<typename... Args>
+    void event_insert_slot(Array<EventSlot<Args...>>& slots, const EventSlot<Args...>& slot)
+    {
+        auto it = std::upper_bound(slots.begin(), slots.end(), slot.priority, [](i32 priority, const EventSlot<Args...>& other) {
+            return priority > other.priority;
+        });
+        slots.insert(it, slot);
+    }
     
     template<typename... Args>
-    void event_add_listener(Event<Args...>& event, const Listener<Args...>& listener)
+    void event_add_listener(Event<Args...>& event, const Listener<Args...>& listener, i32 priority = 0)
     {
         if (delegate_empty(listener))
         {
             NIT_CHECK_MSG(false, "Trying to add empty listener!");
             return;
         }
-        event.listeners.push_back(listener);
+
+        if (event.broadcast_depth != 0)
+        {
+            event.pending.push_back({ listener, priority });
+            return;
+        }
+        event_insert_slot(event.listeners, { listener, priority });
     }
 
     template<typename... Args>
@@ -120,9 +148,24 @@ namespace nit
             NIT_CHECK_MSG(false, "Trying to remove empty listener!");
             return;
         }
-        auto it = std::find(event.listeners.begin(), event.listeners.end(), listener);
+
+        auto matches = [&listener](const EventSlot<Args...>& slot) { return slot.listener == listener; };
+        auto it = std::find_if(event.listeners.begin(), event.listeners.end(), matches);
+        
         if (it == event.listeners.end())
         {
+            auto pending_it = std::find_if(event.pending.begin(), event.pending.end(), matches);
+            if (pending_it != event.pending.end())
+            {
+                event.pending.erase(pending_it);
+            }
+            return;
+        }
+
+        if (event.broadcast_depth != 0)
+        {
+            delegate_unbind(it->listener);
+            ++event.cleared_count;
             return;
         }
         event.listeners.erase(it);
@@ -137,64 +180,81 @@ namespace nit
     template<typename... Args>
     void event_remove_all_listeners(Event<Args...>& event)
     {
+        event.pending.clear();
+        
+        if (event.broadcast_depth != 0)
+        {
+            for (EventSlot<Args...>& slot : event.listeners)
+            {
+                event.cleared_count += !delegate_empty(slot.listener);
+                delegate_unbind(slot.listener);
+            }
+            return;
+        }
         event.listeners.clear();
+        event.cleared_count = 0;
     }
 
     template<typename... Args>
-    void event_broadcast(Event<Args...>& event, Args&&... args)
+    void event_compact(Event<Args...>& event)
     {
-        if (event_empty(event))
+        if (event.cleared_count != 0)
         {
-            return;
-        }
-        
-        Array<Listener<Args...>> listeners_to_remove;
-        listeners_to_remove.reserve(event.listeners.size());
-        
-        for (Listener<Args...>& listener : event.listeners)
-        {
-            switch (listener.function_ptr(std::forward<Args>(args)...))
-            {
-            case ListenerAction::StayListening:
-                break;
-            case ListenerAction::StopListening:
-                listeners_to_remove.push_back(listener);
-                break;
-            }
+            std::erase_if(event.listeners, [](const EventSlot<Args...>& slot) { return delegate_empty(slot.listener); });
+            event.cleared_count = 0;
         }
 
-        for (Listener<Args...>& listener : listeners_to_remove)
+        for (const EventSlot<Args...>& slot : event.pending)
         {
-            event_remove_listener(event, listener);
+            event_insert_slot(event.listeners, slot);
         }
+        event.pending.clear();
     }
 
-    template<typename... Args>
-    void event_broadcast(Event<Args...>& event)
+    // Calls invoke(function_ptr) for the listeners present when the broadcast started.
+    template<typename... Args, typename Invoke>
+    void event_dispatch(Event<Args...>& event, Invoke&& invoke)
     {
         if (event_empty(event))
         {
             return;
         }
+
+        ++event.broadcast_depth;
+        u32 count = (u32) event.listeners.size();
         
-        Array<Listener<Args...>> listeners_to_remove;
-        listeners_to_remove.reserve(event.listeners.size());
-        
-        for (Listener<Args...>& listener : event.listeners)
+        for (u32 i = 0; i < count; ++i)
         {
-            switch (listener.function_ptr())
+            auto function_ptr = event.listeners[i].listener.function_ptr;
+            if (!function_ptr)
             {
-            case ListenerAction::StayListening:
-                break;
-            case ListenerAction::StopListening:
-                listeners_to_remove.push_back(listener);
-                break;
+                continue;
+            }
+
+            // The slot could have been removed by the listener itself, it's cleared already then.
+            Listener<Args...>& listener = event.listeners[i].listener;
+            if (invoke(function_ptr) == ListenerAction::StopListening && !delegate_empty(listener))
+            {
+                delegate_unbind(listener);
+                ++event.cleared_count;
             }
         }
 
-        for (Listener<Args...>& listener : listeners_to_remove)
+        if (--event.broadcast_depth == 0)
         {
-            event_remove_listener(event, listener);
+            event_compact(event);
         }
     }
+
+    template<typename... Args>
+    void event_broadcast(Event<Args...>& event, Args&&... args)
+    {
+        event_dispatch(event, [&](auto function_ptr) { return function_ptr(std::forward<Args>(args)...); });
+    }
+
+    template<typename... Args>
+    void event_broadcast(Event<Args...>& event)
+    {
+        event_dispatch(event, [](auto function_ptr) { return function_ptr(); });
+    }
 }
\ No newline at end of file
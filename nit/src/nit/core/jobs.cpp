@@ -0,0 +1,253 @@
+﻿#include "jobs.h"
+
+#define NIT_CHECK_JOB_SYSTEM_CREATED NIT_CHECK_MSG(job_system, "Forget to call job_system_set_instance!");
+
+namespace nit
+{
+    JobSystem* job_system = nullptr;
+
+    // Queue of the calling thread, the shared one for threads outside the pool.
+    static thread_local u32 job_queue_index = U32_MAX;
+
+    void job_system_set_instance(JobSystem* job_system_instance)
+    {
+        NIT_CHECK(job_system_instance);
+        job_system = job_system_instance;
+    }
+
+    JobSystem* job_system_get_instance()
+    {
+        NIT_CHECK_JOB_SYSTEM_CREATED
+        return job_system;
+    }
+
+    static u32 job_own_queue()
+    {
+        return job_queue_index != U32_MAX ? job_queue_index : (u32) job_system->workers.size();
+    }
+
+    static bool job_pop(Job& job)
+    {
+        u32 queue_count = (u32) job_system->queues.size();
+        u32 own_queue   = job_own_queue();
+
+        for (u32 i = 0; i < queue_count; ++i)
+        {
+            JobQueue& queue = *job_system->queues[(own_queue + i) % queue_count];
+            std::lock_guard lock(queue.mutex);
+
+            if (queue.jobs.empty())
+            {
+                continue;
+            }
+
+            if (i == 0)
+            {
+                job = queue.jobs.back();
+                queue.jobs.pop_back();
+            }
+            else
+            {
+                job = queue.jobs.front();
+                queue.jobs.pop_front();
+            }
+
+            job_system->queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        return false;
+    }
+
+    static void job_push(const Job& job)
+    {
+        {
+            JobQueue& queue = *job_system->queues[job_own_queue()];
+            std::lock_guard lock(queue.mutex);
+            queue.jobs.push_back(job);
+        }
+
+        job_system->queued.fetch_add(1, std::memory_order_relaxed);
+        {
+            // Taking the lock orders the push with a worker checking the queues before going to sleep.
+            std::lock_guard lock(job_system->sleep_mutex);
+        }
+        job_system->wake.notify_one();
+    }
+
+    static void job_execute(const Job& job);
+
+    // Runs the waiting jobs whose dependency is done.
+    static void job_release_waiting()
+    {
+        Array<Job> ready;
+        {
+            std::lock_guard lock(job_system->waiting_mutex);
+            
+            for (u32 i = 0; i < job_system->waiting.size();)
+            {
+                if (job_system->waiting[i].first->pending.load(std::memory_order_acquire) != 0)
+                {
+                    ++i;
+                    continue;
+                }
+
+                ready.push_back(job_system->waiting[i].second);
+                job_system->waiting[i] = job_system->waiting.back();
+                job_system->waiting.pop_back();
+            }
+        }
+
+        for (const Job& job : ready)
+        {
+            job_system->running ? job_push(job) : job_execute(job);
+        }
+    }
+
+    static void job_execute(const Job& job)
+    {
+        job.function(job.data, job.begin, job.end);
+
+        if (job.counter && job.counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1 && job_system)
+        {
+            job_release_waiting();
+        }
+    }
+
+    static void job_worker_main(u32 index)
+    {
+        job_queue_index = index;
+
+        while (true)
+        {
+            Job job;
+            if (job_pop(job))
+            {
+                job_execute(job);
+                continue;
+            }
+
+            std::unique_lock lock(job_system->sleep_mutex);
+            job_system->wake.wait(lock, [] { return job_system->queued.load(std::memory_order_relaxed) != 0 || !job_system->running; });
+
+            if (!job_system->running)
+            {
+                return;
+            }
+        }
+    }
+
+    void job_system_init()
+    {
+        NIT_CHECK_JOB_SYSTEM_CREATED
+        NIT_CHECK_MSG(!job_system->running, "Job system already running!");
+        
+        if (job_system->worker_count == 0)
+        {
+            job_system->worker_count = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+        }
+
+        for (u32 i = 0; i <= job_system->worker_count; ++i)
+        {
+            job_system->queues.push_back(CreateUniquePtr<JobQueue>());
+        }
+
+        job_system->running = true;
+        for (u32 i = 0; i < job_system->worker_count; ++i)
+        {
+            job_system->workers.emplace_back(job_worker_main, i);
+        }
+    }
+
+    // Jobs still queued are run before the workers stop.
+    void job_system_finish()
+    {
+        NIT_CHECK_JOB_SYSTEM_CREATED
+        Job job;
+        while (job_system->running && job_pop(job))
+        {
+            job_execute(job);
+        }
+        
+        {
+            std::lock_guard lock(job_system->sleep_mutex);
+            job_system->running = false;
+        }
+        job_system->wake.notify_all();
+
+        for (std::thread& worker : job_system->workers)
+        {
+            worker.join();
+        }
+
+        job_system->workers.clear();
+        job_system->queues.clear();
+        NIT_CHECK_MSG(job_system->waiting.empty(), "Jobs left waiting for a dependency!");
+    }
+
+    u32 job_thread_count()
+    {
+        return job_system && job_system->running ? (u32) job_system->workers.size() + 1 : 1;
+    }
+
+    void job_run(const Job& job)
+    {
+        NIT_CHECK_MSG(job.function, "Invalid job!");
+        
+        if (job.counter)
+        {
+            job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (!job_system || !job_system->running)
+        {
+            job_execute(job);
+            return;
+        }
+
+        job_push(job);
+    }
+
+    void job_run_after(const JobCounter& dependency, const Job& job)
+    {
+        NIT_CHECK_MSG(job.function, "Invalid job!");
+        
+        if (job.counter)
+        {
+            job.counter->pending.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        if (job_system && job_system->running)
+        {
+            // Checked under the lock, so the job is either seen by the thread finishing the dependency or pushed here.
+            std::lock_guard lock(job_system->waiting_mutex);
+            
+            if (dependency.pending.load(std::memory_order_acquire) != 0)
+            {
+                job_system->waiting.emplace_back(&dependency, job);
+                return;
+            }
+        }
+        else
+        {
+            NIT_CHECK_MSG(dependency.pending == 0, "Dependency can't finish without a running job system!");
+        }
+
+        job_system && job_system->running ? job_push(job) : job_execute(job);
+    }
+
+    void job_wait(const JobCounter& counter)
+    {
+        while (counter.pending.load(std::memory_order_acquire) != 0)
+        {
+            Job job;
+            if (job_system && job_system->running && job_pop(job))
+            {
+                job_execute(job);
+                continue;
+            }
+
+            std::this_thread::yield();
+        }
+    }
+}
@@ -0,0 +1,82 @@
+﻿#pragma once
+
+namespace nit
+{
+    // Counts the jobs given to it that didn't finish yet. It has to outlive them, job_wait is the usual way to get there.
+    struct JobCounter
+    {
+        std::atomic<u32> pending = 0;
+    };
+
+    // Jobs are plain function pointers over a range, so scheduling them never allocates.
+    struct Job
+    {
+        void (*function)(void* data, u32 begin, u32 end) = nullptr;
+        void*       data    = nullptr;
+        u32         begin   = 0;
+        u32         end     = 0;
+        JobCounter* counter = nullptr; // Optional
+    };
+
+    struct JobQueue
+    {
+        std::mutex      mutex;
+        std::deque<Job> jobs;
+    };
+
+    // A worker pops the newest job of its own queue and steals the oldest one from the others when it runs out. Threads
+    // outside the pool share the last queue. Threads waiting on a counter run jobs meanwhile.
+    struct JobSystem
+    {
+        u32                                   worker_count = 0; // 0 uses a worker per hardware thread but the caller's, set before job_system_init
+        Array<std::thread>                    workers;
+        Array<UniquePtr<JobQueue>>            queues;
+        std::atomic<u32>                      queued  = 0;
+        std::atomic<bool>                     running = false;
+        std::mutex                            sleep_mutex;
+        std::condition_variable               wake;
+        std::mutex                            waiting_mutex;
+        Array<Pair<const JobCounter*, Job>>   waiting; // Jobs whose dependency didn't finish yet
+    };
+
+    void       job_system_set_instance(JobSystem* job_system_instance);
+    JobSystem* job_system_get_instance();
+    void       job_system_init();
+    void       job_system_finish();
+    
+    // Threads that can run jobs at the same time, workers plus the caller.
+    u32        job_thread_count();
+
+    // Without a running job system the jobs run right away on the calling thread.
+    void       job_run(const Job& job);
+    void       job_run_after(const JobCounter& dependency, const Job& job);
+    void       job_wait(const JobCounter& counter);
+
+    // Calls func(begin, end) over [0, count) in chunks of grain elements, the calling thread takes the first chunk and
+    // returns once every chunk is done.
+    template<typename Func>
+    void job_parallel_for(u32 count, u32 grain, Func&& func)
+    {
+        grain = std::max(grain, 1u);
+
+        if (count <= grain || job_thread_count() == 1)
+        {
+            if (count != 0)
+            {
+                func(0u, count);
+            }
+            return;
+        }
+
+        using Function = std::remove_reference_t<Func>;
+        JobCounter counter;
+        
+        for (u32 begin = grain; begin < count; begin += grain)
+        {
+            job_run({ [](void* data, u32 begin, u32 end) { (*static_cast<Function*>(data))(begin, end); }, &func, begin, std::min(begin + grain, count), &counter });
+        }
+
+        func(0u, grain);
+        job_wait(counter);
+    }
+}
@@ -10,10 +10,11 @@ namespace nit
             return;
         }
         
+        delete_array(pool->type, pool->elements);
         pool->type = nullptr;
-        free(pool->elements);
         pool->elements = nullptr;
         sparse_release(&pool->sparse_set);
+        pool->next_id = pool->free_id_count = 0;
     }
 
     bool pool_is_valid(Pool* pool, u32 element_id)
@@ -52,11 +53,91 @@ namespace nit
             return false;
         }
         
-        element_id = pool->available_ids.front();
-        pool->available_ids.pop();
+        element_id = pool_claim_id(pool);
         return pool_insert_data_with_id(pool, element_id, data);
     }
 
+    u32 pool_insert_many(Pool* pool, u32 count, u32* out_ids, void* data)
+    {
+        if (!pool || !pool->self_id_management)
+        {
+            NIT_DEBUGBREAK();
+            return SparseSet::INVALID;
+        }
+
+        SparseSet* sparse_set = &pool->sparse_set;
+        u32 first_index = sparse_set->count;
+        pool_reserve(pool, sparse_set->count + count);
+        
+        for (u32 i = 0; i < count; ++i)
+        {
+            u32 element_id = pool_claim_id(pool);
+            set_array_raw_data(pool->type, pool->elements, sparse_insert(sparse_set, element_id), data);
+
+            if (out_ids)
+            {
+                out_ids[i] = element_id;
+            }
+        }
+        
+        return first_index;
+    }
+
+    // Storage grows once for the whole batch and the new elements land after the current ones.
+    u32 pool_insert_many_with_ids(Pool* pool, const u32* element_ids, u32 count, void* data)
+    {
+        if (!pool || pool->self_id_management || (count && !element_ids))
+        {
+            NIT_DEBUGBREAK();
+            return SparseSet::INVALID;
+        }
+
+        SparseSet* sparse_set = &pool->sparse_set;
+        u32 first_index = sparse_set->count;
+        pool_reserve(pool, sparse_set->count + count);
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            sparse_insert(sparse_set, element_ids[i]);
+        }
+
+        for (u32 index = first_index; index < sparse_set->count; ++index)
+        {
+            set_array_raw_data(pool->type, pool->elements, index, data);
+        }
+
+        return first_index;
+    }
+
+    u32 pool_claim_id(Pool* pool)
+    {
+        if (!pool || !pool->self_id_management)
+        {
+            NIT_DEBUGBREAK();
+            return SparseSet::INVALID;
+        }
+
+        SparseSet* sparse_set = &pool->sparse_set;
+        
+        if (sparse_is_full(sparse_set))
+        {
+            pool_resize(pool, sparse_set->max * 2);
+        }
+
+        if (pool->free_id_count == 0)
+        {
+            return pool->next_id++;
+        }
+
+        // Pop the top of the recycled stack, and keep the stack contiguous by moving the id stored
+        // in the slot the next insertion is going to overwrite.
+        u32 top = sparse_set->count + pool->free_id_count - 1;
+        u32 element_id = sparse_set->dense[top];
+        sparse_set->dense[top] = sparse_set->dense[sparse_set->count];
+        --pool->free_id_count;
+        return element_id;
+    }
+
     SparseSetDeletion pool_delete_data(Pool* pool, u32 element_id)
     {
         if (!pool)
@@ -65,28 +146,124 @@ namespace nit
             return { false };
         }
         
+        SparseSetDeletion deletion = sparse_remove(&pool->sparse_set, element_id);
+
+        if (!deletion.succeded)
+        {
+            return deletion;
+        }
+        
+        // Swap and pop, moving instead of copying so non trivial elements don't deep copy.
+        move_array_raw_data(pool->type, pool->elements, deletion.deleted_slot, deletion.last_slot);
+        destroy_array_raw_data(pool->type, pool->elements, deletion.last_slot);
+
         if (pool->self_id_management)
         {
-            pool->available_ids.push(element_id);
+            // The slot released by the removal becomes the bottom of the recycled stack.
+            pool->sparse_set.dense[pool->sparse_set.count] = element_id;
+            ++pool->free_id_count;
         }
         
-        SparseSetDeletion deletion = sparse_remove(&pool->sparse_set, element_id);
-        void* last_element_data = get_array_raw_data(pool->type, pool->elements, deletion.last_slot);
-        set_array_raw_data(pool->type, pool->elements, deletion.deleted_slot, last_element_data);
         return deletion;
     }
 
+    void pool_delete_many(Pool* pool, const u32* element_ids, u32 count)
+    {
+        if (!pool || (count && !element_ids))
+        {
+            NIT_DEBUGBREAK();
+            return;
+        }
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            pool_delete_data(pool, element_ids[i]);
+        }
+    }
+
+    void pool_swap(Pool* pool, u32 index_a, u32 index_b)
+    {
+        if (!pool || index_a >= pool->sparse_set.count || index_b >= pool->sparse_set.count)
+        {
+            NIT_DEBUGBREAK();
+            return;
+        }
+
+        if (index_a == index_b)
+        {
+            return;
+        }
+        
+        swap_array_raw_data(pool->type, pool->elements, index_a, index_b);
+        sparse_swap(&pool->sparse_set, index_a, index_b);
+    }
+
     void pool_resize(Pool* pool, u32 new_max)
     {
-        if (!pool)
+        if (!pool || new_max <= pool->sparse_set.max)
         {
             NIT_DEBUGBREAK();
+            return;
         }
 
-        resize_array(pool->type, pool->elements, pool->sparse_set.max, new_max);
+        pool->elements = resize_array(pool->type, pool->elements, pool->sparse_set.max, new_max);
         sparse_resize(&pool->sparse_set, new_max);
     }
 
+    void pool_copy(Pool* destination, const Pool* source)
+    {
+        if (!destination || !source || (destination->type && destination->type != source->type))
+        {
+            NIT_DEBUGBREAK();
+            return;
+        }
+
+        destination->type = source->type;
+        u32 old_count     = destination->sparse_set.count;
+
+        if (!destination->elements)
+        {
+            destination->elements = create_array(source->type, source->sparse_set.max);
+        }
+        else if (destination->sparse_set.max < source->sparse_set.max)
+        {
+            destination->elements = resize_array(source->type, destination->elements, destination->sparse_set.max, source->sparse_set.max);
+        }
+
+        copy_array(source->type, destination->elements, source->elements, source->sparse_set.count);
+
+        for (u32 i = source->sparse_set.count; i < old_count; ++i)
+        {
+            destroy_array_raw_data(source->type, destination->elements, i);
+        }
+
+        sparse_copy(&destination->sparse_set, &source->sparse_set);
+        destination->next_id            = source->next_id;
+        destination->free_id_count      = source->free_id_count;
+        destination->self_id_management = source->self_id_management;
+    }
+
+    void pool_reserve(Pool* pool, u32 capacity)
+    {
+        if (!pool || !sparse_is_valid(&pool->sparse_set))
+        {
+            NIT_DEBUGBREAK();
+            return;
+        }
+
+        u32 new_max = pool->sparse_set.max;
+
+        while (new_max < capacity)
+        {
+            new_max *= 2;
+        }
+
+        if (new_max != pool->sparse_set.max)
+        {
+            pool_resize(pool, new_max);
+        }
+    }
+
     u32 pool_index_of(Pool* pool, u32 element_id)
     {
         if (!pool)
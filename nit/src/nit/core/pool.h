@@ -7,7 +7,8 @@ namespace nit
         Type*          type                = nullptr;
         void*          elements            = nullptr;
         SparseSet      sparse_set          = {};
-        Queue<u32>     available_ids       = {};
+        u32            next_id             = 0;
+        u32            free_id_count       = 0; // Recycled ids are stacked in the dense slots after count
         bool           self_id_management  = false;
     };
 
@@ -15,14 +16,23 @@ namespace nit
     bool              pool_is_valid(Pool* pool, u32 element_id);  
     bool              pool_insert_data_with_id(Pool* pool, u32 element_id, void* data = nullptr);
     bool              pool_insert_data(Pool* pool, u32& element_id, void* data = nullptr);
+    u32               pool_insert_many(Pool* pool, u32 count, u32* out_ids = nullptr, void* data = nullptr);
+    u32               pool_insert_many_with_ids(Pool* pool, const u32* element_ids, u32 count, void* data = nullptr);
+    u32               pool_claim_id(Pool* pool);
     u32               pool_index_of(Pool* pool, u32 element_id);
     void*             pool_get_raw_data(Pool* pool, u32 element_id);
     SparseSetDeletion pool_delete_data(Pool* pool, u32 element_id);
+    void              pool_delete_many(Pool* pool, const u32* element_ids, u32 count);
+    void              pool_swap(Pool* pool, u32 index_a, u32 index_b);
     void              pool_resize(Pool* pool, u32 new_max);
+    void              pool_reserve(Pool* pool, u32 capacity);
+    void              pool_copy(Pool* destination, const Pool* source); // Destination is empty or of the same type
     
-    template<typename T> void pool_load(Pool* pool, u32 max_element_count, bool self_id_management = true);
+    // Storage starts with initial_capacity elements and grows geometrically on insertion.
+    template<typename T> void pool_load(Pool* pool, u32 initial_capacity, bool self_id_management = true);
     template<typename T> T*   pool_insert_data_with_id(Pool* pool, u32 element_id, const T& data);
     template<typename T> T*   pool_insert_data(Pool* pool, u32& out_id, const T& data = {});
+    template<typename T> T*   pool_insert_many(Pool* pool, u32 count, u32* out_ids = nullptr, const T& data = {});
     template<typename T> T*   pool_get_data(Pool* pool, u32 element_id);
 }
 
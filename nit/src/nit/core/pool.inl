@@ -3,7 +3,7 @@
 namespace nit
 {
     template<typename T>
-    void pool_load(Pool* pool, u32 max_element_count, bool self_id_management)
+    void pool_load(Pool* pool, u32 initial_capacity, bool self_id_management)
     {
         if (!pool)
         {
@@ -16,19 +16,18 @@ namespace nit
             RegisterType<T>();
         }
         
-        pool->type = GetType<T>();
-        pool->elements  = new T[max_element_count];
-        
-        sparse_load(&pool->sparse_set, max_element_count);
-        
-        if (self_id_management)
+        if (initial_capacity == 0)
         {
-            for (u32 i = 0; i < max_element_count; ++i)
-            {
-                pool->available_ids.push(i);
-            }
+            initial_capacity = 1;
         }
         
+        pool->type = GetType<T>();
+        pool->elements  = new T[initial_capacity];
+        
+        sparse_load(&pool->sparse_set, initial_capacity);
+        
+        pool->next_id            = 0;
+        pool->free_id_count      = 0;
         pool->self_id_management = self_id_management;
     }
     
@@ -59,10 +58,26 @@ namespace nit
             return nullptr;
         }
         
-        out_id = pool->available_ids.front();
-        pool->available_ids.pop();
+        out_id = pool_claim_id(pool);
         return pool_insert_data_with_id(pool, out_id, data);
     }
+
+    template<typename T>
+    T* pool_insert_many(Pool* pool, u32 count, u32* out_ids, const T& data)
+    {
+        if (!pool || !pool->self_id_management)
+        {
+            NIT_DEBUGBREAK();
+            return nullptr;
+        }
+
+        NIT_CHECK_MSG(pool->type == GetType<T>(), "Type mismatch!");
+        
+        // New elements are appended, so they end up contiguous in the elements array.
+        u32 first_index = pool->sparse_set.count;
+        pool_insert_many(pool, count, out_ids, (void*) &data);
+        return count ? GetArrayData<T>(pool->elements, first_index) : nullptr;
+    }
     
     template<typename T>
     T* pool_get_data(Pool* pool, u32 element_id)
@@ -2,6 +2,49 @@
 
 namespace nit
 {
+    static u32* sparse_get_slot(SparseSet* sparse_set, u32 element)
+    {
+        u32 page = element / SparseSet::PAGE_SIZE;
+        
+        if (page >= sparse_set->page_count || !sparse_set->sparse[page])
+        {
+            return nullptr;
+        }
+        
+        return &sparse_set->sparse[page][element % SparseSet::PAGE_SIZE];
+    }
+
+    static u32* sparse_assure_slot(SparseSet* sparse_set, u32 element)
+    {
+        u32 page = element / SparseSet::PAGE_SIZE;
+        
+        if (page >= sparse_set->page_count)
+        {
+            u32 new_page_count = sparse_set->page_count ? sparse_set->page_count : 1;
+            
+            while (new_page_count <= page)
+            {
+                new_page_count *= 2;
+            }
+            
+            u32** new_pages = new u32*[new_page_count];
+            std::copy_n(sparse_set->sparse, sparse_set->page_count, new_pages);
+            std::fill_n(new_pages + sparse_set->page_count, new_page_count - sparse_set->page_count, nullptr);
+            
+            delete[] sparse_set->sparse;
+            sparse_set->sparse     = new_pages;
+            sparse_set->page_count = new_page_count;
+        }
+        
+        if (!sparse_set->sparse[page])
+        {
+            sparse_set->sparse[page] = new u32[SparseSet::PAGE_SIZE];
+            memset(sparse_set->sparse[page], SparseSet::INVALID, sizeof(u32) * SparseSet::PAGE_SIZE);
+        }
+        
+        return &sparse_set->sparse[page][element % SparseSet::PAGE_SIZE];
+    }
+    
     bool sparse_is_valid(SparseSet* sparse_set)
     {
         return sparse_set && sparse_set->max != 0;
@@ -31,16 +74,17 @@ namespace nit
 
     void sparse_load(SparseSet* sparse_set, u32 max)
     {
-        if (!sparse_set || max == U32_MAX)
+        if (!sparse_set || max == 0 || max == U32_MAX)
         {
             NIT_DEBUGBREAK();
             return;
         }
 
-        sparse_set->max = max;
-        sparse_set->sparse = new u32[max];
-        sparse_set->dense  = new u32[max];
-        memset(sparse_set->sparse, SparseSet::INVALID, sizeof(u32) * max);
+        sparse_set->max        = max;
+        sparse_set->count      = 0;
+        sparse_set->sparse     = nullptr;
+        sparse_set->page_count = 0;
+        sparse_set->dense      = new u32[max];
     }
     
     u32 sparse_insert(SparseSet* sparse_set, u32 element)
@@ -57,7 +101,7 @@ namespace nit
         }
         
         u32 next_slot = sparse_set->count;
-        sparse_set->sparse[element] = next_slot;
+        *sparse_assure_slot(sparse_set, element) = next_slot;
         sparse_set->dense[next_slot] = element;
         ++sparse_set->count;
         return next_slot;
@@ -71,25 +115,26 @@ namespace nit
             return false;
         }
         
-        return element < sparse_set->max && sparse_set->sparse[element] != SparseSet::INVALID;
+        u32* slot = sparse_get_slot(sparse_set, element);
+        return slot && *slot != SparseSet::INVALID;
     }
 
     u32 sparse_search(SparseSet* sparse_set, u32 element)
     {
-        if (!sparse_is_valid(sparse_set) || element >= sparse_set->max)
+        if (!sparse_is_valid(sparse_set))
         {
             NIT_DEBUGBREAK();
             return SparseSet::INVALID;
         }
 
-        u32 dense_index = sparse_set->sparse[element];
+        u32* slot = sparse_get_slot(sparse_set, element);
         
-        if (dense_index == SparseSet::INVALID)
+        if (!slot)
         {
             return SparseSet::INVALID;
         }
         
-        return dense_index;
+        return *slot;
     }
     
     SparseSetDeletion sparse_remove(SparseSet* sparse_set, u32 element)
@@ -100,10 +145,11 @@ namespace nit
             return { false };
         }
         
-        u32 deleted_slot = sparse_set->sparse[element];
+        u32* slot = sparse_get_slot(sparse_set, element);
+        u32 deleted_slot = *slot;
         u32 last_slot = sparse_set->count - 1;
         
-        sparse_set->sparse[element] = SparseSet::INVALID;
+        *slot = SparseSet::INVALID;
         --sparse_set->count;
 
         if (deleted_slot == last_slot)
@@ -114,32 +160,42 @@ namespace nit
         u32 last_element = sparse_set->dense[last_slot];
         sparse_set->dense[deleted_slot] = last_element;
         
-        sparse_set->sparse[last_element] = deleted_slot;
+        *sparse_get_slot(sparse_set, last_element) = deleted_slot;
         return { true, deleted_slot, last_slot };
     }
 
-    void sparse_resize(SparseSet* sparse_set, u32 new_max)
+    void sparse_swap(SparseSet* sparse_set, u32 slot_a, u32 slot_b)
     {
-        if (!sparse_is_valid(sparse_set) || new_max > sparse_set->max)
+        if (!sparse_is_valid(sparse_set) || slot_a >= sparse_set->count || slot_b >= sparse_set->count)
         {
             NIT_DEBUGBREAK();
             return;
         }
         
-        u32* new_sparse = new u32[new_max];
-        u32* new_dense  = new u32[new_max];
-    
-        std::copy_n(sparse_set->sparse, sparse_set->max, new_sparse);
-        memset(new_sparse + sparse_set->max, SparseSet::INVALID, (new_max - sparse_set->max) * sizeof(u32));
+        u32 element_a = sparse_set->dense[slot_a];
+        u32 element_b = sparse_set->dense[slot_b];
+        sparse_set->dense[slot_a] = element_b;
+        sparse_set->dense[slot_b] = element_a;
+        *sparse_get_slot(sparse_set, element_a) = slot_b;
+        *sparse_get_slot(sparse_set, element_b) = slot_a;
+    }
+
+    void sparse_resize(SparseSet* sparse_set, u32 new_max)
+    {
+        if (!sparse_is_valid(sparse_set) || new_max <= sparse_set->max)
+        {
+            NIT_DEBUGBREAK();
+            return;
+        }
         
+        // Only the dense array is bounded by max, the sparse pages grow on demand.
+        // The unused tail is copied too since pools keep their recycled ids there.
+        u32* new_dense = new u32[new_max];
         std::copy_n(sparse_set->dense, sparse_set->max, new_dense);
-    
-        delete[] sparse_set->sparse;
         delete[] sparse_set->dense;
     
-        sparse_set->sparse = new_sparse;
-        sparse_set->dense  = new_dense;
-        sparse_set->max    = new_max;
+        sparse_set->dense = new_dense;
+        sparse_set->max   = new_max;
     }
 
     void sparse_release(SparseSet* sparse_set)
@@ -152,6 +208,11 @@ namespace nit
         
         if (sparse_set->sparse)
         {
+            for (u32 i = 0; i < sparse_set->page_count; ++i)
+            {
+                delete[] sparse_set->sparse[i];
+            }
+            
             delete[] sparse_set->sparse;
             sparse_set->sparse = nullptr;
         }
@@ -161,6 +222,39 @@ namespace nit
             sparse_set->dense = nullptr;
         }
         
-        sparse_set->count = sparse_set->max = 0;
+        sparse_set->count = sparse_set->max = sparse_set->page_count = 0;
+    }
+
+    // Reuses the destination pages and dense array when they are big enough, the dense array never shrinks.
+    void sparse_copy(SparseSet* destination, const SparseSet* source)
+    {
+        if (!destination || !source || source->max == 0)
+        {
+            NIT_DEBUGBREAK();
+            return;
+        }
+
+        if (destination->max < source->max)
+        {
+            delete[] destination->dense;
+            destination->dense = new u32[source->max];
+            destination->max   = source->max;
+        }
+
+        std::copy_n(source->dense, source->max, destination->dense);
+        destination->count = source->count;
+
+        for (u32 page = 0; page < std::max(destination->page_count, source->page_count); ++page)
+        {
+            if (page < source->page_count && source->sparse[page])
+            {
+                u32* slot = sparse_assure_slot(destination, page * SparseSet::PAGE_SIZE);
+                std::copy_n(source->sparse[page], SparseSet::PAGE_SIZE, slot);
+            }
+            else if (page < destination->page_count && destination->sparse[page])
+            {
+                memset(destination->sparse[page], SparseSet::INVALID, sizeof(u32) * SparseSet::PAGE_SIZE);
+            }
+        }
     }
-}
\ No newline at end of file
+}
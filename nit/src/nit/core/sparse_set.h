@@ -4,12 +4,15 @@ namespace nit
 {
     struct SparseSet
     {
-        static constexpr u32 INVALID = U32_MAX;
-        
-        u32* sparse = nullptr;
-        u32* dense  = nullptr;
-        u32  count  = 0;
-        u32  max    = 0;
+        static constexpr u32 INVALID   = U32_MAX;
+        static constexpr u32 PAGE_SIZE = 1024;
+
+        // Sparse pages are allocated on first touch, max is the capacity of the dense array.
+        u32** sparse     = nullptr;
+        u32   page_count = 0;
+        u32*  dense      = nullptr;
+        u32   count      = 0;
+        u32   max        = 0;
     };
     
     struct SparseSetDeletion
@@ -27,6 +30,8 @@ namespace nit
     bool              sparse_test     (SparseSet* sparse_set, u32 element);
     u32               sparse_search   (SparseSet* sparse_set, u32 element);
     SparseSetDeletion sparse_remove   (SparseSet* sparse_set, u32 element);
+    void              sparse_swap     (SparseSet* sparse_set, u32 slot_a, u32 slot_b);
     void              sparse_resize   (SparseSet* sparse_set, u32 new_max);
     void              sparse_release  (SparseSet* sparse_set);
+    void              sparse_copy     (SparseSet* destination, const SparseSet* source);
 }
\ No newline at end of file
@@ -19,6 +19,13 @@ namespace nit
     void set_array_raw_data(const Type* type, void* array, u32 index, void* data)
     {
         NIT_CHECK(type && type->fn_set_data && array);
+        
+        if (type->trivially_copyable && data)
+        {
+            memcpy(static_cast<u8*>(array) + (u64) index * type->size, data, type->size);
+            return;
+        }
+        
         type->fn_set_data(array, index, data);
     }
 
@@ -28,15 +35,115 @@ namespace nit
         return type->fn_get_data(array, index);
     }
 
-    void resize_array(const Type* type, void* array, u32 max, u32 new_max)
+    void* create_array(const Type* type, u32 count)
+    {
+        if (!type || !type->fn_create_data || count == 0)
+        {
+            NIT_DEBUGBREAK();
+            return nullptr;
+        }
+        
+        return type->fn_create_data(count);
+    }
+
+    void* resize_array(const Type* type, void* array, u32 max, u32 new_max)
     {
         if (!type || !type->fn_resize_data || !array || new_max <= max)
         {
             NIT_DEBUGBREAK();
+            return array;
+        }
+        
+        return type->fn_resize_data(array, max, new_max);
+    }
+
+    void delete_array(const Type* type, void* array)
+    {
+        NIT_CHECK(type && type->fn_delete_data);
+        if (array)
+        {
+            type->fn_delete_data(array);
+        }
+    }
+
+    void move_array_raw_data(const Type* type, void* array, u32 to_index, u32 from_index)
+    {
+        NIT_CHECK(type && type->fn_move_data && array);
+        
+        if (to_index == from_index)
+        {
+            return;
+        }
+        
+        if (type->trivially_copyable)
+        {
+            u8* bytes = static_cast<u8*>(array);
+            memcpy(bytes + (u64) to_index * type->size, bytes + (u64) from_index * type->size, type->size);
+            return;
+        }
+        
+        type->fn_move_data(array, to_index, from_index);
+    }
+
+    void relocate_array(const Type* type, void* destination, void* source, u32 count)
+    {
+        NIT_CHECK(type && type->fn_relocate_data && destination && source);
+        
+        if (type->trivially_copyable)
+        {
+            memcpy(destination, source, (u64) count * type->size);
+            return;
+        }
+        
+        type->fn_relocate_data(destination, source, count);
+    }
+
+    void copy_array(const Type* type, void* destination, void* source, u32 count)
+    {
+        NIT_CHECK(type && type->fn_set_data && destination && source);
+        
+        if (type->trivially_copyable)
+        {
+            memcpy(destination, source, (u64) count * type->size);
+            return;
+        }
+        
+        for (u32 i = 0; i < count; ++i)
+        {
+            type->fn_set_data(destination, i, get_array_raw_data(type, source, i));
+        }
+    }
+
+    void destroy_array_raw_data(const Type* type, void* array, u32 index)
+    {
+        NIT_CHECK(type && type->fn_destroy_data && array);
+        
+        // Trivially copyable types don't own anything.
+        if (type->trivially_copyable)
+        {
+            return;
+        }
+        
+        type->fn_destroy_data(array, index);
+    }
+
+    void swap_array_raw_data(const Type* type, void* array, u32 index_a, u32 index_b)
+    {
+        NIT_CHECK(type && type->fn_swap_data && array);
+        
+        if (index_a == index_b)
+        {
+            return;
+        }
+        
+        if (type->trivially_copyable)
+        {
+            u8* bytes = static_cast<u8*>(array);
+            std::swap_ranges(bytes + (u64) index_a * type->size, bytes + (u64) (index_a + 1) * type->size, bytes + (u64) index_b * type->size);
             return;
         }
         
-        type->fn_resize_data(array, max, new_max);
+        type->fn_swap_data(array, index_a, index_b);
     }
 
     void load(const Type* type, void* data)
@@ -8,7 +8,13 @@ namespace nit
     {
         using FnSetData           = void  (*) (void*, u32, void*);
         using FnGetData           = void* (*) (void*, u32);
+        using FnCreateData        = void* (*) (u32);
         using FnResizeData        = void* (*) (void*, u32, u32);
+        using FnDeleteData        = void  (*) (void*);
+        using FnMoveData          = void  (*) (void*, u32, u32);
+        using FnRelocateData      = void  (*) (void*, void*, u32);
+        using FnDestroyData       = void  (*) (void*, u32);
+        using FnSwapData          = void  (*) (void*, u32, u32);
         using FnInvokeLoad        = Function<void(void*)>;
         using FnInvokeFree        = Function<void(void*)>;
         using FnInvokeSerialize   = Function<void(void*, YAML::Emitter& emitter)>;
@@ -20,9 +26,17 @@ namespace nit
         
         String              name;
         u64                 hash                  = 0;
+        u32                 size                  = 0;
+        bool                trivially_copyable    = false; // Elements can be moved around with memcpy
         FnSetData           fn_set_data           = nullptr;
         FnGetData           fn_get_data           = nullptr;
+        FnCreateData        fn_create_data        = nullptr;
         FnResizeData        fn_resize_data        = nullptr;
+        FnDeleteData        fn_delete_data        = nullptr;
+        FnMoveData          fn_move_data          = nullptr;
+        FnRelocateData      fn_relocate_data      = nullptr;
+        FnDestroyData       fn_destroy_data       = nullptr;
+        FnSwapData          fn_swap_data          = nullptr;
         FnInvokeLoad        fn_invoke_load        = nullptr;
         FnInvokeFree        fn_invoke_free        = nullptr;
         FnInvokeSerialize   fn_invoke_serialize   = nullptr;
@@ -107,7 +121,14 @@ namespace nit
 
     void  set_array_raw_data(const Type* type, void* array, u32 index, void* data);
     void* get_array_raw_data(const Type* type, void* array, u32 index);
-    void  resize_array(const Type* type, void* array, u32 max, u32 new_max);
+    void* create_array(const Type* type, u32 count);
+    void* resize_array(const Type* type, void* array, u32 max, u32 new_max);
+    void  delete_array(const Type* type, void* array);
+    void  move_array_raw_data(const Type* type, void* array, u32 to_index, u32 from_index);
+    void  relocate_array(const Type* type, void* destination, void* source, u32 count);
+    void  copy_array(const Type* type, void* destination, void* source, u32 count);
+    void  destroy_array_raw_data(const Type* type, void* array, u32 index);
+    void  swap_array_raw_data(const Type* type, void* array, u32 index_a, u32 index_b);
     void  load(const Type* type, void* data);
     void  type_release(const Type* type, void* data);
     void  serialize(const Type* type, void* data, YAML::Emitter& emitter);
@@ -82,6 +82,8 @@ namespace nit
     void init_type(Type& type, const TypeArgs<T>& args)
     {
         type.hash = get_type_hash<T>();
+        type.size = sizeof(T);
+        type.trivially_copyable = std::is_trivially_copyable_v<T>;
         
         static const String STRUCT_TEXT = "struct "; 
         static const String CLASS_TEXT  = "class "; 
@@ -105,13 +107,43 @@ namespace nit
             return data;
         };
 
+        type.fn_create_data = [](u32 count) -> void* {
+            return new T[count];
+        };
+
         type.fn_resize_data = [](void* elements, u32 max, u32 new_max) -> void* {
             T* casted_elements = static_cast<T*>(elements);
             T* new_elements = new T[new_max];
-            std::copy_n(casted_elements, max, new_elements);
-            delete [] new_elements;
+            std::move(casted_elements, casted_elements + max, new_elements);
+            delete [] casted_elements;
             return new_elements;
         };
+
+        type.fn_move_data = [](void* elements, u32 to_index, u32 from_index) {
+            T* casted_elements = static_cast<T*>(elements);
+            casted_elements[to_index] = std::move(casted_elements[from_index]);
+        };
+
+        type.fn_relocate_data = [](void* destination, void* source, u32 count) {
+            T* casted_source = static_cast<T*>(source);
+            std::move(casted_source, casted_source + count, static_cast<T*>(destination));
+        };
+
+        // Elements live in arrays of constructed objects, destroying one means releasing what it owns.
+        type.fn_destroy_data = [](void* elements, u32 element_index) {
+            T* casted_elements = static_cast<T*>(elements);
+            casted_elements[element_index] = T{};
+        };
+
+        type.fn_swap_data = [](void* elements, u32 index_a, u32 index_b) {
+            T* casted_elements = static_cast<T*>(elements);
+            std::swap(casted_elements[index_a], casted_elements[index_b]);
+        };
+
+        type.fn_delete_data = [](void* elements) {
+            T* casted_elements = static_cast<T*>(elements);
+            delete [] casted_elements;
+        };
         
         if (auto fn_serialize = args.fn_serialize)
         {
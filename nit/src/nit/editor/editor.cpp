@@ -5,6 +5,7 @@
 #include "logic/draw_system.h"
 #include "core/engine.h"
 #include "logic/components.h"
+#include "logic/transform_system.h"
 #include "logic/scene.h"
 #include "render/texture.h"
 #include <ImGuizmo.h>
@@ -156,7 +157,7 @@ namespace nit
         {
             auto& camera     = entity_get<Camera>(editor->editor_camera_entity); 
             auto& controller = entity_get<EditorCameraController>(editor->editor_camera_entity);
-            auto& transform  = entity_get<Transform>(editor->editor_camera_entity);
+            auto& transform  = entity_patch<Transform>(editor->editor_camera_entity);
             
             // Zoom stuff
 
@@ -304,8 +305,7 @@ namespace nit
                     
                     if (IsEntityValid(selected_entity) && editor->selection == Editor::Selection::Entity && IsEntityValid(camera_entity) && entity_has<Transform>(selected_entity))
                     {
-                        auto& camera_data      = entity_get<Camera>(camera_entity);
-                        auto& camera_transform = entity_get<Transform>(camera_entity);
+                        auto& camera_data      = entity_get<const Camera>(camera_entity);
                         
                         ImGuizmo::SetOrthographic(camera_data.projection == CameraProjection::Orthographic);
                         ImGuizmo::SetDrawlist();
@@ -321,24 +321,33 @@ namespace nit
                         if (ImGui::IsKeyPressed(ImGuiKey_E)) operation = ImGuizmo::ROTATE;
                         if (ImGui::IsKeyPressed(ImGuiKey_R)) operation = ImGuizmo::SCALE;
 
-                        const float* view = &CalculateViewMatrix(camera_transform).n[0];
-                        const float* projection = &CalculateProjectionMatrix(camera_data).n[0];
+                        Matrix4 view       = CalculateViewMatrix(transform_world_matrix(camera_entity));
+                        Matrix4 projection = CalculateProjectionMatrix(camera_data);
 
-                        Transform& transform = entity_get<Transform>(selected_entity);
+                        const Transform& transform = entity_get<const Transform>(selected_entity);
                         
-                        Matrix4 gizmo_matrix = CreateTransform(transform.position, transform.rotation, transform.scale);
+                        // The gizmo works in world space, the result is brought back to the parent space.
+                        Entity  parent       = transform_get_parent(selected_entity);
+                        bool    has_parent   = IsEntityValid(parent) && entity_has<Transform>(parent);
+                        Matrix4 gizmo_matrix = has_parent ? transform_world_matrix(parent) * ToMatrix4(transform) : ToMatrix4(transform);
                         
-                        ImGuizmo::Manipulate(view, projection, operation, mode, &gizmo_matrix.n[0], nullptr, snap_enabled ? &snap : nullptr);
+                        ImGuizmo::Manipulate(&view.n[0], &projection.n[0], operation, mode, &gizmo_matrix.n[0], nullptr, snap_enabled ? &snap : nullptr);
 
                         if (ImGuizmo::IsUsing())
                         {
+                            if (has_parent)
+                            {
+                                gizmo_matrix = Inverse(transform_world_matrix(parent)) * gizmo_matrix;
+                            }
+                            
                             Vector3 position, rotation, scale;
                             Decompose(gizmo_matrix, position, rotation, scale);
                             Vector3 delta_rotation = rotation - transform.rotation; 
+                            Transform& edited = entity_patch<Transform>(selected_entity);
                             
-                            transform.position = position;
-                            transform.rotation += delta_rotation;
-                            transform.scale = scale;
+                            edited.position = position;
+                            edited.rotation += delta_rotation;
+                            edited.scale = scale;
                         }
                     }
                 }
@@ -411,7 +420,7 @@ namespace nit
                         if (ImGui::MenuItem(info->name.c_str()))
                         {
                             asset_deserialize_from_file(info->path);
-                            asset_load(scene_asset);
+                            scene_load_async(scene_asset);
                         }
                     }
                     ImGui::EndMenu();
@@ -505,8 +514,8 @@ namespace nit
 
                         if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
                         {
-                            auto& transform = entity_get<Transform>(entity);
-                            auto& camera_transform  = entity_get<Transform>(editor->editor_camera_entity);
+                            auto& transform = entity_get<const Transform>(entity);
+                            auto& camera_transform  = entity_patch<Transform>(editor->editor_camera_entity);
                             auto& camera_controller = entity_get<EditorCameraController>(editor->editor_camera_entity);
                             auto pos = Vector3{ transform.position.x, transform.position.y, camera_transform.position.z };
                             camera_controller.aux_position = pos;
@@ -576,9 +585,18 @@ namespace nit
 
                         if (pool->data_pool.type->fn_invoke_draw_editor)
                         {
-                            void* data = pool_get_raw_data(&pool->data_pool, selected_entity);
+                            void* data = delegate_invoke(pool->fn_get_from_entity, selected_entity);
                             NIT_CHECK(data);
-                            type_draw_editor(component_type, data);
+
+                            if (editor_draw_type(component_type, data))
+                            {
+                                entity_patch(pool, selected_entity);
+
+                                if (component_type == GetType<Name>())
+                                {
+                                    name_index_refresh(selected_entity);
+                                }
+                            }
                         }
                         
                         ImGui::Separator();
@@ -812,6 +830,8 @@ namespace nit
             stats_text.append("\nFrames: "   + std::to_string(engine_get_instance()->frame_count));
             stats_text.append("\nFPS: "      + std::to_string(engine_get_instance()->frame_count / engine_get_instance()->seconds));
             stats_text.append("\nEntities: " + std::to_string(engine_get_instance()->entity_registry.entity_count));
+            stats_text.append("\nDrawn: "    + std::to_string(get_draw_stats().drawn));
+            stats_text.append("\nCulled: "   + std::to_string(get_draw_stats().culled));
             stats_text.append("\nDelta: "    + std::to_string(delta_seconds()));
             ImGui::Text(stats_text.c_str());
             ImGui::End();
@@ -837,6 +857,21 @@ namespace nit
         {
             editor->enabled = !editor->enabled;
             engine_get_instance()->im_gui_renderer.use_dockspace = editor->enabled;
+
+            if (!editor->enabled)
+            {
+                entity_registry_snapshot(editor->play_snapshot);
+            }
+            else
+            {
+                entity_registry_restore(editor->play_snapshot);
+                entity_registry_snapshot_release(editor->play_snapshot);
+
+                if (editor->selection == Editor::Selection::Entity && !IsEntityValid(editor->selected_entity))
+                {
+                    editor->selection = Editor::Selection::None;
+                }
+            }
         }
         ImGui::End();
     }
@@ -44,6 +44,7 @@ namespace nit
         bool        show_assets          = true;
         bool        show_stats           = false;
         
+        EntityRegistrySnapshot play_snapshot; // Taken when switching to the game, restored when coming back
         Pool             asset_nodes;
         u32              root_node = U32_MAX;
         u32              draw_node = U32_MAX;
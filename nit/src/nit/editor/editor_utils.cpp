@@ -204,6 +204,8 @@ namespace nit
         PushStyleColor(ImGuiCol_Button, { reset_color.x, reset_color.y, reset_color.z, reset_color.w });
 
         const bool reset = Button(label, button_size);
+        if (reset)
+            MarkItemEdited(GetItemID());
 
         PopStyleColor();
         SameLine();
@@ -351,6 +353,18 @@ namespace nit
         
         editor_end_property();
     }
+
+    bool editor_draw_type(const Type* type, void* data)
+    {
+        // Widgets report their edits through MarkItemEdited, the flag is cleared around the draw to only see this type's.
+        ImGuiContext& g = *GImGui;
+        const bool edited_before = g.ActiveIdHasBeenEditedThisFrame;
+        g.ActiveIdHasBeenEditedThisFrame = false;
+        type_draw_editor(type, data);
+        const bool edited = g.ActiveIdHasBeenEditedThisFrame;
+        g.ActiveIdHasBeenEditedThisFrame |= edited_before;
+        return edited;
+    }
 }
 
 #endif
\ No newline at end of file
@@ -32,6 +32,9 @@ namespace nit
     bool editor_draw_color_palette(const char* label, Vector4& color);
     auto editor_draw_asset_combo(const char* label, Type* type, AssetHandle* asset) -> void;
     void editor_draw_resource_combo(const char* label, const Array<String>& extensions, String& selected);
+
+    // Draws the editor of the type, returns true if any of its widgets was edited this frame.
+    bool editor_draw_type(const Type* type, void* data);
     
     template<typename T>
     void editor_draw_enum_combo(const char* label, T& enum_data)
@@ -0,0 +1,350 @@
+﻿#include "entity.h"
+
+namespace nit
+{
+    static void* archetype_column_element(const Archetype* archetype, u32 column, u32 row)
+    {
+        const ArchetypeChunk& chunk = archetype->chunks[row / archetype->chunk_capacity];
+        return static_cast<u8*>(chunk.columns[column]) + (u64) (row % archetype->chunk_capacity) * archetype->types[column]->size;
+    }
+
+    static ComponentTicks& archetype_column_ticks(const Archetype* archetype, u32 column, u32 row)
+    {
+        const ArchetypeChunk& chunk = archetype->chunks[row / archetype->chunk_capacity];
+        return chunk.ticks[column][row % archetype->chunk_capacity];
+    }
+
+    static ArchetypeChunk archetype_chunk_create(const Array<Type*>& types, u32 chunk_capacity)
+    {
+        ArchetypeChunk chunk;
+        chunk.entities = new Entity[chunk_capacity];
+        chunk.columns  = new void*[types.size()];
+        chunk.ticks    = new ComponentTicks*[types.size()];
+
+        for (u32 column = 0; column < types.size(); ++column)
+        {
+            chunk.columns[column] = create_array(types[column], chunk_capacity);
+            chunk.ticks[column]   = new ComponentTicks[chunk_capacity];
+        }
+
+        return chunk;
+    }
+
+    static void archetype_chunk_free(const Array<Type*>& types, ArchetypeChunk& chunk)
+    {
+        for (u32 column = 0; column < types.size(); ++column)
+        {
+            delete_array(types[column], chunk.columns[column]);
+            delete[] chunk.ticks[column];
+        }
+
+        delete[] chunk.columns;
+        delete[] chunk.ticks;
+        delete[] chunk.entities;
+        chunk = {};
+    }
+
+    // Rows past the source count are destroyed so they release what they own.
+    static void archetype_chunk_copy(const Array<Type*>& types, ArchetypeChunk& destination, const ArchetypeChunk& source)
+    {
+        std::copy_n(source.entities, source.count, destination.entities);
+
+        for (u32 column = 0; column < types.size(); ++column)
+        {
+            if (source.count != 0)
+            {
+                copy_array(types[column], destination.columns[column], source.columns[column], source.count);
+                std::copy_n(source.ticks[column], source.count, destination.ticks[column]);
+            }
+
+            for (u32 row = source.count; row < destination.count; ++row)
+            {
+                destroy_array_raw_data(types[column], destination.columns[column], row);
+            }
+        }
+
+        destination.count = source.count;
+    }
+
+    static u32 archetype_push_row(Archetype* archetype, Entity entity)
+    {
+        u32 row   = archetype->count;
+        u32 chunk = row / archetype->chunk_capacity;
+
+        if (chunk == archetype->chunks.size())
+        {
+            archetype->chunks.push_back(archetype_chunk_create(archetype->types, archetype->chunk_capacity));
+        }
+
+        ArchetypeChunk& target_chunk = archetype->chunks[chunk];
+        target_chunk.entities[row % archetype->chunk_capacity] = entity;
+        ++target_chunk.count;
+        ++archetype->count;
+        return row;
+    }
+
+    // Swap and pop, the last row is moved into the removed one and the entity that owned it gets relocated.
+    static void archetype_remove_row(Archetype* archetype, u32 row)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 last_row = archetype->count - 1;
+
+        if (row != last_row)
+        {
+            for (u32 column = 0; column < archetype->types.size(); ++column)
+            {
+                relocate_array(archetype->types[column], archetype_column_element(archetype, column, row), archetype_column_element(archetype, column, last_row), 1);
+                archetype_column_ticks(archetype, column, row) = archetype_column_ticks(archetype, column, last_row);
+            }
+
+            Entity moved_entity = archetype->chunks[last_row / archetype->chunk_capacity].entities[last_row % archetype->chunk_capacity];
+            archetype->chunks[row / archetype->chunk_capacity].entities[row % archetype->chunk_capacity] = moved_entity;
+            entity_registry->entity_locations[entity_index(moved_entity)].row = row;
+        }
+
+        ArchetypeChunk& last_chunk = archetype->chunks[last_row / archetype->chunk_capacity];
+        for (u32 column = 0; column < archetype->types.size(); ++column)
+        {
+            destroy_array_raw_data(archetype->types[column], last_chunk.columns[column], last_row % archetype->chunk_capacity);
+        }
+
+        --last_chunk.count;
+        --archetype->count;
+    }
+
+    u32 archetype_get_or_create(const EntitySignature& signature)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+
+        if (auto it = entity_registry->archetype_lookup.find(signature); it != entity_registry->archetype_lookup.end())
+        {
+            return it->second;
+        }
+
+        Archetype* archetype = new Archetype();
+        archetype->signature = signature;
+        archetype->column_of.fill(Archetype::NO_COLUMN);
+
+        u32 row_size = sizeof(Entity);
+        for (u32 type_index = 1; type_index < entity_registry->next_component_type_index; ++type_index)
+        {
+            if (!signature.test(type_index))
+            {
+                continue;
+            }
+
+            Type* type = entity_registry->component_pool[type_index - 1].data_pool.type;
+            archetype->column_of[type_index] = (u16) archetype->types.size();
+            archetype->type_indices.push_back(type_index);
+            archetype->types.push_back(type);
+            row_size += type->size;
+        }
+
+        archetype->chunk_capacity = std::max(1u, (u32) NIT_ARCHETYPE_CHUNK_SIZE / row_size);
+
+        u32 archetype_index = (u32) entity_registry->archetypes.size();
+        entity_registry->archetypes.push_back(archetype);
+        entity_registry->archetype_lookup[signature] = archetype_index;
+        return archetype_index;
+    }
+
+    void archetype_move_entity(Entity entity, const EntitySignature& new_signature, u32 added_type_index, void* data)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(entity_registry->storage == EntityStorage::Archetypes, "Registry is not using archetype storage!");
+        EntityLocation& location = entity_registry->entity_locations[entity_index(entity)];
+
+        // Entities without components don't take rows.
+        EntitySignature components = new_signature;
+        components.set(0, false);
+        u32 target_index = components.any() ? archetype_get_or_create(new_signature) : U32_MAX;
+
+        if (target_index == location.archetype)
+        {
+            if (target_index != U32_MAX && added_type_index != 0)
+            {
+                Archetype* archetype = entity_registry->archetypes[target_index];
+                u32 column = archetype->column_of[added_type_index];
+                const ArchetypeChunk& chunk = archetype->chunks[location.row / archetype->chunk_capacity];
+                set_array_raw_data(archetype->types[column], chunk.columns[column], location.row % archetype->chunk_capacity, data);
+                archetype_column_ticks(archetype, column, location.row).changed = entity_registry->change_tick;
+            }
+            return;
+        }
+
+        Archetype* source = location.archetype != U32_MAX ? entity_registry->archetypes[location.archetype] : nullptr;
+        EntityLocation new_location = { target_index, 0 };
+
+        if (target_index != U32_MAX)
+        {
+            Archetype* target = entity_registry->archetypes[target_index];
+            new_location.row = archetype_push_row(target, entity);
+
+            for (u32 column = 0; column < target->types.size(); ++column)
+            {
+                u32 type_index = target->type_indices[column];
+
+                if (source && source->column_of[type_index] != Archetype::NO_COLUMN)
+                {
+                    relocate_array(target->types[column], archetype_column_element(target, column, new_location.row), archetype_column_element(source, source->column_of[type_index], location.row), 1);
+                    archetype_column_ticks(target, column, new_location.row) = archetype_column_ticks(source, source->column_of[type_index], location.row);
+                }
+                else if (type_index == added_type_index)
+                {
+                    const ArchetypeChunk& chunk = target->chunks[new_location.row / target->chunk_capacity];
+                    set_array_raw_data(target->types[column], chunk.columns[column], new_location.row % target->chunk_capacity, data);
+                    archetype_column_ticks(target, column, new_location.row) = { entity_registry->change_tick, entity_registry->change_tick };
+                }
+            }
+        }
+
+        if (source)
+        {
+            archetype_remove_row(source, location.row);
+        }
+
+        location = new_location;
+    }
+
+    // Rows are appended back to back, the template values are copied column by column.
+    void archetype_insert_many(const Entity* entities, u32 count, const EntityTemplate& entity_template)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 archetype_index  = archetype_get_or_create(entity_template.signature);
+        Archetype* archetype = entity_registry->archetypes[archetype_index];
+        u32 first_row        = archetype->count;
+
+        for (u32 i = 0; i < count; ++i)
+        {
+            entity_registry->entity_locations[entity_index(entities[i])] = { archetype_index, archetype_push_row(archetype, entities[i]) };
+        }
+
+        for (u32 i = 0; i < entity_template.type_indices.size(); ++i)
+        {
+            u32 column = archetype->column_of[entity_template.type_indices[i]];
+
+            for (u32 row = first_row; row < archetype->count; ++row)
+            {
+                const ArchetypeChunk& chunk = archetype->chunks[row / archetype->chunk_capacity];
+                set_array_raw_data(archetype->types[column], chunk.columns[column], row % archetype->chunk_capacity, entity_template.values[i]);
+                chunk.ticks[column][row % archetype->chunk_capacity] = { entity_registry->change_tick, entity_registry->change_tick };
+            }
+        }
+    }
+
+    void* archetype_get_component(Entity entity, u32 type_index)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        const EntityLocation& location = entity_registry->entity_locations[entity_index(entity)];
+
+        if (location.archetype == U32_MAX)
+        {
+            return nullptr;
+        }
+
+        const Archetype* archetype = entity_registry->archetypes[location.archetype];
+        u16 column = archetype->column_of[type_index];
+        return column != Archetype::NO_COLUMN ? archetype_column_element(archetype, column, location.row) : nullptr;
+    }
+
+    ComponentTicks* archetype_get_ticks(Entity entity, u32 type_index)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        const EntityLocation& location = entity_registry->entity_locations[entity_index(entity)];
+
+        if (location.archetype == U32_MAX)
+        {
+            return nullptr;
+        }
+
+        const Archetype* archetype = entity_registry->archetypes[location.archetype];
+        u16 column = archetype->column_of[type_index];
+        return column != Archetype::NO_COLUMN ? &archetype_column_ticks(archetype, column, location.row) : nullptr;
+    }
+
+    void archetype_release_all()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+
+        for (Archetype* archetype : entity_registry->archetypes)
+        {
+            for (ArchetypeChunk& chunk : archetype->chunks)
+            {
+                archetype_chunk_free(archetype->types, chunk);
+            }
+
+            delete archetype;
+        }
+
+        entity_registry->archetypes.clear();
+        entity_registry->archetype_lookup.clear();
+    }
+
+    // Only the chunks holding rows are copied.
+    void archetype_snapshot(Array<ArchetypeSnapshot>& snapshots)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        archetype_snapshot_release(snapshots);
+        snapshots.resize(entity_registry->archetypes.size());
+
+        for (u32 i = 0; i < entity_registry->archetypes.size(); ++i)
+        {
+            const Archetype* archetype = entity_registry->archetypes[i];
+            ArchetypeSnapshot& snapshot = snapshots[i];
+            snapshot.types          = archetype->types;
+            snapshot.chunk_capacity = archetype->chunk_capacity;
+            snapshot.count          = archetype->count;
+
+            for (u32 chunk = 0; chunk * archetype->chunk_capacity < archetype->count; ++chunk)
+            {
+                ArchetypeChunk& copy = snapshot.chunks.emplace_back(archetype_chunk_create(archetype->types, archetype->chunk_capacity));
+                archetype_chunk_copy(archetype->types, copy, archetype->chunks[chunk]);
+            }
+        }
+    }
+
+    // Chunks filled after the snapshot are freed, so archetypes created after it are left empty.
+    void archetype_restore(const Array<ArchetypeSnapshot>& snapshots)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(snapshots.size() <= entity_registry->archetypes.size(), "Snapshot from another registry!");
+
+        for (u32 i = 0; i < entity_registry->archetypes.size(); ++i)
+        {
+            Archetype* archetype = entity_registry->archetypes[i];
+            const ArchetypeSnapshot* snapshot = i < snapshots.size() ? &snapshots[i] : nullptr;
+            u32 chunk_count = snapshot ? (u32) snapshot->chunks.size() : 0;
+
+            while (archetype->chunks.size() < chunk_count)
+            {
+                archetype->chunks.push_back(archetype_chunk_create(archetype->types, archetype->chunk_capacity));
+            }
+
+            while (archetype->chunks.size() > chunk_count)
+            {
+                archetype_chunk_free(archetype->types, archetype->chunks.back());
+                archetype->chunks.pop_back();
+            }
+
+            for (u32 chunk = 0; chunk < chunk_count; ++chunk)
+            {
+                archetype_chunk_copy(archetype->types, archetype->chunks[chunk], snapshot->chunks[chunk]);
+            }
+
+            archetype->count = snapshot ? snapshot->count : 0;
+        }
+    }
+
+    void archetype_snapshot_release(Array<ArchetypeSnapshot>& snapshots)
+    {
+        for (ArchetypeSnapshot& snapshot : snapshots)
+        {
+            for (ArchetypeChunk& chunk : snapshot.chunks)
+            {
+                archetype_chunk_free(snapshot.types, chunk);
+            }
+        }
+
+        snapshots.clear();
+    }
+}
@@ -0,0 +1,283 @@
+﻿#include "entity.h"
+
+namespace nit
+{
+    static void entity_command_overwrite(ComponentPool* component_pool, Entity entity, void* payload)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        void* component = entity_registry->storage == EntityStorage::Archetypes
+            ? archetype_get_component(entity, component_pool->type_index)
+            : pool_get_raw_data(&component_pool->data_pool, entity_index(entity));
+        
+        set_array_raw_data(component_pool->data_pool.type, component, 0, payload);
+        entity_component_ticks(component_pool, entity)->changed = entity_registry->change_tick;
+        event_broadcast<const ComponentOverwrittenArgs&>(entity_registry->component_overwritten_event, {entity, component_pool->data_pool.type});
+    }
+
+    static void entity_command_columns_release(Array<EntityCommandColumn>& columns)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+
+        for (u32 i = 0; i < columns.size(); ++i)
+        {
+            if (columns[i].data)
+            {
+                delete_array(entity_registry->component_pool[i].data_pool.type, columns[i].data);
+            }
+        }
+
+        columns.clear();
+    }
+
+    // Folds the commands of the same entity and component, in recording order, into the one to apply.
+    static EntityCommand entity_command_coalesce(const EntityCommand* commands, u32 count)
+    {
+        EntityCommand result = commands[0];
+
+        for (u32 i = 1; i < count; ++i)
+        {
+            const EntityCommand& command = commands[i];
+
+            if (command.type == EntityCommandType::Set && result.type != EntityCommandType::Set)
+            {
+                // Setting a component added by the buffer updates the payload, setting a removed one does nothing.
+                if (result.type == EntityCommandType::Add)
+                {
+                    result.data_index = command.data_index;
+                }
+                continue;
+            }
+
+            result = command;
+        }
+
+        return result;
+    }
+
+    EntityCommandBuffer& entity_commands()
+    {
+        return entity_registry_get_instance()->commands;
+    }
+
+    Entity entity_command_create(EntityCommandBuffer& buffer)
+    {
+        std::lock_guard lock(buffer.mutex);
+        NIT_CHECK_MSG(buffer.created_count < MAX_ENTITIES, "Too many entities created in the command buffer!");
+        return entity_compose(buffer.created_count++, ENTITY_VERSION_MASK);
+    }
+
+    void entity_command_destroy(EntityCommandBuffer& buffer, Entity entity)
+    {
+        entity_command_record(buffer, EntityCommandType::Destroy, entity, 0);
+    }
+
+    void entity_command_record(EntityCommandBuffer& buffer, EntityCommandType type, Entity entity, u32 type_index, const void* data)
+    {
+        NIT_CHECK_MSG(entity != NULL_ENTITY, "Invalid entity!");
+        NIT_CHECK_MSG(type == EntityCommandType::Destroy || type_index != 0, "Invalid component type!");
+        std::lock_guard lock(buffer.mutex);
+
+        EntityCommand& command = buffer.commands.emplace_back();
+        command.type       = type;
+        command.type_index = type_index;
+        command.entity     = entity;
+
+        if (type != EntityCommandType::Add && type != EntityCommandType::Set)
+        {
+            return;
+        }
+
+        if (buffer.columns.size() < type_index)
+        {
+            buffer.columns.resize(type_index);
+        }
+
+        EntityCommandColumn& column = buffer.columns[type_index - 1];
+        const Type* component_type = entity_registry_get_instance()->component_pool[type_index - 1].data_pool.type;
+
+        if (column.count == column.capacity)
+        {
+            u32 new_capacity = column.capacity != 0 ? column.capacity * 2 : 16;
+            column.data      = column.data ? resize_array(component_type, column.data, column.capacity, new_capacity) : create_array(component_type, new_capacity);
+            column.capacity  = new_capacity;
+        }
+
+        command.data_index = column.count++;
+        set_array_raw_data(component_type, column.data, command.data_index, const_cast<void*>(data));
+    }
+
+    void entity_command_buffer_playback(EntityCommandBuffer& buffer)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        Array<EntityCommand>       commands;
+        Array<EntityCommandColumn> columns;
+        u32                        created_count;
+
+        // Take the recorded commands so listeners can record new ones while these are applied.
+        {
+            std::lock_guard lock(buffer.mutex);
+            commands.swap(buffer.commands);
+            columns.swap(buffer.columns);
+            created_count = std::exchange(buffer.created_count, 0);
+        }
+
+        // Destroys go first, in one batch. Placeholders destroyed by the same buffer are marked so they are never created.
+        Array<Entity> created(created_count, 0);
+        Array<Entity> destroyed;
+
+        for (const EntityCommand& command : commands)
+        {
+            if (command.type != EntityCommandType::Destroy)
+            {
+                continue;
+            }
+
+            if (entity_is_placeholder(command.entity))
+            {
+                created[entity_index(command.entity)] = NULL_ENTITY;
+            }
+            else if (IsEntityValid(command.entity))
+            {
+                destroyed.push_back(command.entity);
+            }
+        }
+
+        if (!destroyed.empty())
+        {
+            std::sort(destroyed.begin(), destroyed.end());
+            destroyed.erase(std::unique(destroyed.begin(), destroyed.end()), destroyed.end());
+            entity_destroy_many({ destroyed.data(), destroyed.size() });
+        }
+
+        for (Entity& entity : created)
+        {
+            if (entity != NULL_ENTITY)
+            {
+                entity = CreateEntity();
+            }
+        }
+
+        // Commands on entities that are gone by now are dropped.
+        u32 kept = 0;
+        for (EntityCommand& command : commands)
+        {
+            if (command.type == EntityCommandType::Destroy)
+            {
+                continue;
+            }
+
+            if (entity_is_placeholder(command.entity))
+            {
+                NIT_CHECK_MSG(entity_index(command.entity) < created_count, "Placeholder entity from another command buffer!");
+                command.entity = created[entity_index(command.entity)];
+            }
+
+            if (IsEntityValid(command.entity))
+            {
+                commands[kept++] = command;
+            }
+        }
+        commands.resize(kept);
+
+        std::stable_sort(commands.begin(), commands.end(), [](const EntityCommand& a, const EntityCommand& b) {
+            return a.type_index != b.type_index ? a.type_index < b.type_index : entity_index(a.entity) < entity_index(b.entity);
+        });
+
+        // Overwrites are applied in place, additions and removals of each component type are gathered into one batch.
+        Array<Entity> added;
+        Array<void*>  added_data;
+        Array<Entity> removed;
+
+        for (u32 first = 0; first < commands.size();)
+        {
+            u32 type_index = commands[first].type_index;
+            ComponentPool* component_pool = &entity_registry->component_pool[type_index - 1];
+            Type*          component_type = component_pool->data_pool.type;
+
+            added.clear();
+            added_data.clear();
+            removed.clear();
+
+            u32 last = first;
+            while (last < commands.size() && commands[last].type_index == type_index)
+            {
+                ++last;
+            }
+
+            for (u32 i = first; i < last;)
+            {
+                u32 run = i + 1;
+                while (run < last && commands[run].entity == commands[i].entity)
+                {
+                    ++run;
+                }
+
+                EntityCommand command = entity_command_coalesce(&commands[i], run - i);
+                bool has_component = entity_registry->signatures[entity_index(command.entity)].test(type_index);
+                void* payload = command.type != EntityCommandType::Remove ? get_array_raw_data(component_type, columns[type_index - 1].data, command.data_index) : nullptr;
+                i = run;
+
+                if (command.type == EntityCommandType::Remove)
+                {
+                    if (has_component)
+                    {
+                        removed.push_back(command.entity);
+                    }
+                }
+                else if (command.type == EntityCommandType::Add && !has_component)
+                {
+                    added.push_back(command.entity);
+                    added_data.push_back(payload);
+                }
+                else if (has_component)
+                {
+                    entity_command_overwrite(component_pool, command.entity, payload);
+                }
+            }
+
+            if (!removed.empty())
+            {
+                Span<const Entity> entities = { removed.data(), removed.size() };
+                event_broadcast<const ComponentsRemovedArgs&>(entity_registry->components_removed_event, {component_type, entities});
+                entity_defer_removed(component_pool, entities);
+                entity_erase_component_many(component_pool, entities);
+            }
+
+            if (!added.empty())
+            {
+                Span<const Entity> entities = { added.data(), added.size() };
+                entity_insert_component_many(component_pool, entities, added_data.data());
+                event_broadcast<const ComponentsAddedArgs&>(entity_registry->components_added_event, {component_type, entities});
+                entity_defer_added(component_pool, entities);
+            }
+
+            first = last;
+        }
+
+        // Hand the storage back if nothing was recorded meanwhile, so the next frame doesn't allocate again.
+        std::lock_guard lock(buffer.mutex);
+
+        if (buffer.commands.empty() && buffer.columns.empty())
+        {
+            commands.clear();
+            buffer.commands.swap(commands);
+
+            for (EntityCommandColumn& column : columns)
+            {
+                column.count = 0;
+            }
+            buffer.columns.swap(columns);
+            return;
+        }
+
+        entity_command_columns_release(columns);
+    }
+
+    void entity_command_buffer_release(EntityCommandBuffer& buffer)
+    {
+        std::lock_guard lock(buffer.mutex);
+        entity_command_columns_release(buffer.columns);
+        buffer.commands.clear();
+        buffer.created_count = 0;
+    }
+}
@@ -83,28 +83,106 @@ namespace nit
         return name.data.find(other) != String::npos;
     }
 
-    Entity FindEntityByName(const String& name)
+    static u64 name_hash(const String& name)
+    {
+        return std::hash<String>()(name);
+    }
+
+    void name_index_refresh(Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+
+        if (!entity_has<Name>(entity))
+        {
+            entity_hash_index_erase(entity_registry->name_index, entity);
+            return;
+        }
+
+        entity_hash_index_insert(entity_registry->name_index, name_hash(entity_get<const Name>(entity).data), entity);
+    }
+
+    // The index follows the component through the registry events, so any way of adding, removing or overwriting it
+    // through the command buffer is seen.
+    static ListenerAction on_name_added(const ComponentAddedArgs& args)
+    {
+        if (args.type == GetType<Name>())
+        {
+            name_index_refresh(args.entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_name_overwritten(const ComponentOverwrittenArgs& args)
+    {
+        if (args.type == GetType<Name>())
+        {
+            name_index_refresh(args.entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_name_removed(const ComponentRemovedArgs& args)
     {
-        for (Entity entity : entity_get_group<Name>().entities)
+        if (args.type == GetType<Name>())
         {
-            if (entity_get<Name>(entity).data == name)
+            entity_hash_index_erase(entity_registry_get_instance()->name_index, args.entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_names_added(const ComponentsAddedArgs& args)
+    {
+        if (args.type == GetType<Name>())
+        {
+            for (Entity entity : args.entities)
+            {
+                name_index_refresh(entity);
+            }
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_names_removed(const ComponentsRemovedArgs& args)
+    {
+        if (args.type == GetType<Name>())
+        {
+            for (Entity entity : args.entities)
             {
-                return entity;
+                entity_hash_index_erase(entity_registry_get_instance()->name_index, entity);
             }
         }
+        return ListenerAction::StayListening;
+    }
 
-        return NULL_ENTITY;
+    void SetName(Entity entity, const String& name)
+    {
+        entity_patch<Name>(entity).data = name;
+        name_index_refresh(entity);
+    }
+
+    Entity FindEntityByName(const String& name)
+    {
+        Entity result = NULL_ENTITY;
+        entity_hash_index_find(entity_registry_get_instance()->name_index, name_hash(name), [&](Entity entity) {
+            if (entity_get<const Name>(entity).data != name)
+            {
+                return true;
+            }
+            result = entity;
+            return false;
+        });
+        return result;
     }
 
     void FindEntitiesByName(Array<Entity>& entities, const String& name)
     {
-        for (Entity entity : entity_get_group<Name>().entities)
-        {
-            if (entity_get<Name>(entity).data == name)
+        entity_hash_index_find(entity_registry_get_instance()->name_index, name_hash(name), [&](Entity entity) {
+            if (entity_get<const Name>(entity).data == name)
             {
                 entities.push_back(entity);
             }
-        }
+            return true;
+        });
     }
 
     void SerializeName(const Name* name, YAML::Emitter& emitter)
@@ -137,6 +215,11 @@ namespace nit
         });
 
         entity_create_group<Name>();
+        entity_registry_get_instance()->component_added_event    += ComponentAddedListener::create(on_name_added);
+        entity_registry_get_instance()->component_removed_event  += ComponentRemovedListener::create(on_name_removed);
+        entity_registry_get_instance()->component_overwritten_event += ComponentOverwrittenListener::create(on_name_overwritten);
+        entity_registry_get_instance()->components_added_event   += ComponentsAddedListener::create(on_names_added);
+        entity_registry_get_instance()->components_removed_event += ComponentsRemovedListener::create(on_names_removed);
     }
 
     bool IsValid(const UUID& uuid)
@@ -154,28 +237,85 @@ namespace nit
         return !(a == b);
     }
 
-    Entity FindEntityByUUID(UUID uuid)
+    static void uuid_index_refresh(Entity entity)
+    {
+        entity_hash_index_insert(entity_registry_get_instance()->uuid_index, entity_get<const UUID>(entity).data, entity);
+    }
+
+    static ListenerAction on_uuid_added(const ComponentAddedArgs& args)
+    {
+        if (args.type == GetType<UUID>())
+        {
+            uuid_index_refresh(args.entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_uuid_overwritten(const ComponentOverwrittenArgs& args)
     {
-        for (Entity entity : entity_get_group<UUID>().entities)
+        if (args.type == GetType<UUID>())
         {
-            if (entity_get<UUID>(entity) == uuid)
+            uuid_index_refresh(args.entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_uuid_removed(const ComponentRemovedArgs& args)
+    {
+        if (args.type == GetType<UUID>())
+        {
+            entity_hash_index_erase(entity_registry_get_instance()->uuid_index, args.entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_uuids_added(const ComponentsAddedArgs& args)
+    {
+        if (args.type == GetType<UUID>())
+        {
+            for (Entity entity : args.entities)
             {
-                return entity;
+                uuid_index_refresh(entity);
             }
         }
+        return ListenerAction::StayListening;
+    }
 
-        return NULL_ENTITY;
+    static ListenerAction on_uuids_removed(const ComponentsRemovedArgs& args)
+    {
+        if (args.type == GetType<UUID>())
+        {
+            for (Entity entity : args.entities)
+            {
+                entity_hash_index_erase(entity_registry_get_instance()->uuid_index, entity);
+            }
+        }
+        return ListenerAction::StayListening;
+    }
+
+    Entity FindEntityByUUID(UUID uuid)
+    {
+        Entity result = NULL_ENTITY;
+        entity_hash_index_find(entity_registry_get_instance()->uuid_index, uuid.data, [&](Entity entity) {
+            if (entity_get<const UUID>(entity) != uuid)
+            {
+                return true;
+            }
+            result = entity;
+            return false;
+        });
+        return result;
     }
 
     void FindEntitiesByUUID(Array<Entity>& entities, UUID uuid)
     {
-        for (Entity entity : entity_get_group<UUID>().entities)
-        {
-            if (entity_get<UUID>(entity) == uuid)
+        entity_hash_index_find(entity_registry_get_instance()->uuid_index, uuid.data, [&](Entity entity) {
+            if (entity_get<const UUID>(entity) == uuid)
             {
                 entities.push_back(entity);
             }
-        }
+            return true;
+        });
     }
 
     void SerializeUUID(const UUID* uuid, YAML::Emitter& emitter)
@@ -208,6 +348,11 @@ namespace nit
         });
 
         entity_create_group<UUID>();
+        entity_registry_get_instance()->component_added_event    += ComponentAddedListener::create(on_uuid_added);
+        entity_registry_get_instance()->component_removed_event  += ComponentRemovedListener::create(on_uuid_removed);
+        entity_registry_get_instance()->component_overwritten_event += ComponentOverwrittenListener::create(on_uuid_overwritten);
+        entity_registry_get_instance()->components_added_event   += ComponentsAddedListener::create(on_uuids_added);
+        entity_registry_get_instance()->components_removed_event += ComponentsRemovedListener::create(on_uuids_removed);
     }
 
     void SerializeCamera(const Camera* camera, YAML::Emitter& emitter)
@@ -261,6 +406,11 @@ namespace nit
         return CalculateProjectionMatrix(camera) * CalculateViewMatrix(transform);
     }
 
+    Matrix4 camera_proj_view(const Camera& camera, const Matrix4& world_matrix)
+    {
+        return CalculateProjectionMatrix(camera) * CalculateViewMatrix(world_matrix);
+    }
+
     Matrix4 CalculateProjectionMatrix(const Camera& camera)
     {
         Matrix4 proj;
@@ -290,6 +440,11 @@ namespace nit
         return Inverse(ToMatrix4(transform));
     }
 
+    Matrix4 CalculateViewMatrix(const Matrix4& world_matrix)
+    {
+        return Inverse(world_matrix);
+    }
+
     void SerializeText(const Text* text, YAML::Emitter& emitter)
     {
         emitter << YAML::Key << "font"    << YAML::Value << text->font;
@@ -28,8 +28,12 @@ namespace nit
     bool operator!=(const Name& a, const Name& b);
     bool Contains(const Name& name, const String& other);
 
+    // Lookups go through a hash index kept by the registry. Writing the name in place leaves the index stale, use
+    // SetName or call name_index_refresh afterwards.
     Entity FindEntityByName(const String& name);
     void FindEntitiesByName(Array<Entity>& entities, const String& name);
+    void SetName(Entity entity, const String& name);
+    void name_index_refresh(Entity entity);
     
     void register_name_component();
 
@@ -54,8 +58,10 @@ namespace nit
     void register_camera_component();
     
     Matrix4 camera_proj_view(const Camera& camera, const Transform& transform= { {0.f, 0.f, 3.f} });
+    Matrix4 camera_proj_view(const Camera& camera, const Matrix4& world_matrix);
     Matrix4 CalculateProjectionMatrix(const Camera& camera);
     Matrix4 CalculateViewMatrix(const Transform& transform);
+    Matrix4 CalculateViewMatrix(const Matrix4& world_matrix);
 
     struct Font;
     
@@ -4,6 +4,9 @@
 #include "nit/core/engine.h"
 #include "nit/logic/entity.h"
 #include "nit/logic/components.h"
+#include "nit/logic/transform_system.h"
+#include "nit/logic/spatial_system.h"
+#include "nit/logic/draw_system.h"
 #include "nit/render/texture.h"
 #include "nit/render/font.h"
 
@@ -12,6 +15,11 @@ namespace nit
     V4Verts2D vertex_positions = DEFAULT_VERTEX_POSITIONS_2D;
     V2Verts2D vertex_uvs       = DEFAULT_VERTEX_U_VS_2D;
     V4Verts2D vertex_colors    = DEFAULT_VERTEX_COLORS_2D;
+
+    static DrawStats      draw_stats;
+    static Array<Entity>  visible_entities;
+    static Array<u8>      visible;  // By entity index, filled from the spatial index each frame
+    static Array<Sprite*> added_sprites;
     
     ListenerAction start();
     ListenerAction end();
@@ -20,6 +28,52 @@ namespace nit
     static ListenerAction on_asset_destroyed(const AssetDestroyedArgs& args);
     static ListenerAction on_component_added(const ComponentAddedArgs& args);
     static ListenerAction on_component_removed(const ComponentRemovedArgs& args);
+    static ListenerAction on_components_added(const ComponentsAddedArgs& args);
+    static ListenerAction on_components_removed(const ComponentsRemovedArgs& args);
+    static ListenerAction on_deferred_added(const ComponentsAddedArgs& args);
+    static ListenerAction on_registry_restored();
+
+    const DrawStats& get_draw_stats()
+    {
+        return draw_stats;
+    }
+
+    // World space rectangle seen by the camera on the z = 0 plane. Perspective corners that never reach the plane
+    // leave the view unbounded.
+    static bool calculate_view_bounds(const Camera& camera, const Matrix4& proj_view, Bounds2D& bounds)
+    {
+        Matrix4 inverse = Inverse(proj_view);
+        bounds = { { F32_MAX, F32_MAX }, { -F32_MAX, -F32_MAX } };
+
+        for (f32 x : { -1.f, 1.f })
+        {
+            for (f32 y : { -1.f, 1.f })
+            {
+                Vector4 near_point = inverse * Vector4{ x, y, -1.f, 1.f };
+                near_point /= near_point.w;
+                Vector2 corner = { near_point.x, near_point.y };
+
+                if (camera.projection == CameraProjection::Perspective)
+                {
+                    Vector4 far_point = inverse * Vector4{ x, y, 1.f, 1.f };
+                    far_point /= far_point.w;
+
+                    if ((near_point.z > 0.f) == (far_point.z > 0.f))
+                    {
+                        return false;
+                    }
+
+                    f32 t  = near_point.z / (near_point.z - far_point.z);
+                    corner = { near_point.x + (far_point.x - near_point.x) * t, near_point.y + (far_point.y - near_point.y) * t };
+                }
+
+                bounds.min = { std::min(bounds.min.x, corner.x), std::min(bounds.min.y, corner.y) };
+                bounds.max = { std::max(bounds.max.x, corner.x), std::max(bounds.max.y, corner.y) };
+            }
+        }
+
+        return true;
+    }
 
     Entity get_main_camera()
     {
@@ -34,12 +88,9 @@ namespace nit
 
         if (!engine_get_instance()->editor.enabled)
         {
-            for (Entity entity : camera_group.entities)
+            for (Entity entity : entity_view<Camera, Transform>(exclude<EditorCameraController>))
             {
-                if (!entity_has<EditorCameraController>(entity))
-                {
-                    return entity;
-                }
+                return entity;
             }
         }
 
@@ -56,11 +107,11 @@ namespace nit
         engine_event(Stage::End)    += EngineListener::create(end);
         engine_event(Stage::Draw)   += EngineListener::create(draw);
         
-        entity_create_group<Sprite, Transform>();
+        entity_create_owning_group<Sprite, Transform>();
         entity_create_group<Camera, Transform>();
-        entity_create_group<Circle, Transform>();
-        entity_create_group<Line2D, Transform>();
-        entity_create_group<Text,   Transform>();
+        entity_create_group<Circle, WorldTransform>();
+        entity_create_group<Line2D, WorldTransform>();
+        entity_create_group<Text, WorldTransform>();
     }
     
     ListenerAction start()
@@ -68,6 +119,11 @@ namespace nit
         engine_get_instance()->asset_registry.asset_destroyed_event    += AssetDestroyedListener::create(on_asset_destroyed);
         engine_get_instance()->entity_registry.component_added_event   += ComponentAddedListener::create(on_component_added);
         engine_get_instance()->entity_registry.component_removed_event += ComponentRemovedListener::create(on_component_removed);
+        engine_get_instance()->entity_registry.components_added_event   += ComponentsAddedListener::create(on_components_added);
+        engine_get_instance()->entity_registry.components_removed_event += ComponentsRemovedListener::create(on_components_removed);
+        engine_get_instance()->entity_registry.restored_event           += Listener<>::create(on_registry_restored);
+        engine_get_instance()->entity_registry.deferred_added_event     += ComponentsAddedListener::create(on_deferred_added);
+        entity_defer_events<Sprite>();
         return ListenerAction::StayListening;
     }
 
@@ -76,6 +132,11 @@ namespace nit
         engine_get_instance()->asset_registry.asset_destroyed_event    -= AssetDestroyedListener::create(on_asset_destroyed);
         engine_get_instance()->entity_registry.component_added_event   -= ComponentAddedListener::create(on_component_added);
         engine_get_instance()->entity_registry.component_removed_event -= ComponentRemovedListener::create(on_component_removed);
+        engine_get_instance()->entity_registry.components_added_event   -= ComponentsAddedListener::create(on_components_added);
+        engine_get_instance()->entity_registry.components_removed_event -= ComponentsRemovedListener::create(on_components_removed);
+        engine_get_instance()->entity_registry.restored_event           -= Listener<>::create(on_registry_restored);
+        engine_get_instance()->entity_registry.deferred_added_event     -= ComponentsAddedListener::create(on_deferred_added);
+        entity_defer_events<Sprite>(false);
         return ListenerAction::StayListening;
     }
     
@@ -93,12 +154,35 @@ namespace nit
         return ListenerAction::StayListening;
     }
 
-    static ListenerAction on_component_added(const ComponentAddedArgs& args)
+    // Sprites come in batches from the deferred events. Sorted by texture and sub texture, each texture is resolved
+    // and retained once and each sub texture name looked up once.
+    static void sprites_added(Span<const Entity> entities)
     {
-        if (args.type == GetType<Sprite>())
+        added_sprites.clear();
+        for (Entity entity : entities)
         {
-            auto& sprite = entity_get<Sprite>(args.entity); 
-            auto& asset = sprite.texture;
+            added_sprites.push_back(&entity_get<Sprite>(entity));
+        }
+
+        std::sort(added_sprites.begin(), added_sprites.end(), [](const Sprite* a, const Sprite* b) {
+            return a->texture.id.data != b->texture.id.data ? a->texture.id.data < b->texture.id.data : a->sub_texture < b->sub_texture;
+        });
+
+        const Sprite* resolved = nullptr;
+        Texture2D*    texture  = nullptr;
+        
+        for (Sprite* sprite : added_sprites)
+        {
+            auto& asset = sprite->texture;
+
+            if (resolved && IsValid(asset.id) && asset.id == resolved->texture.id && asset.type == resolved->texture.type)
+            {
+                asset = resolved->texture;
+                sprite->sub_texture_index = !texture ? -1 : sprite->sub_texture == resolved->sub_texture
+                    ? resolved->sub_texture_index : texture_2d_get_sub_tex_index(texture, sprite->sub_texture);
+                resolved = sprite;
+                continue;
+            }
 
             asset_retarget_handle(asset);
 
@@ -109,32 +193,30 @@ namespace nit
                 asset_retain(asset);
             }
 
-            if (is_valid)
-            {
-                sprite.sub_texture_index = texture_2d_get_sub_tex_index(asset_get_data<Texture2D>(asset), sprite.sub_texture);
-            }
-            else
-            {
-                sprite.sub_texture_index = -1;
-            }
+            texture = is_valid ? asset_get_data<Texture2D>(asset) : nullptr;
+            sprite->sub_texture_index = texture ? texture_2d_get_sub_tex_index(texture, sprite->sub_texture) : -1;
+            resolved = sprite;
         }
-        else if (args.type == GetType<Text>())
+    }
+
+    static void component_added(Type* type, Entity entity)
+    {
+        if (type == GetType<Text>())
         {
-            auto& asset = entity_get<Text>(args.entity).font;
+            auto& asset = entity_get<Text>(entity).font;
             asset_retarget_handle(asset);
             if (asset_valid(asset) && !asset_loaded(asset))
             {
                 asset_retain(asset);
             }
         }
-        return ListenerAction::StayListening;
     }
 
-    static ListenerAction on_component_removed(const ComponentRemovedArgs& args)
+    static void component_removed(Type* type, Entity entity)
     {
-        if (args.type == GetType<Sprite>())
+        if (type == GetType<Sprite>())
         {
-            auto& sprite = entity_get<Sprite>(args.entity); 
+            auto& sprite = entity_get<Sprite>(entity); 
             auto& asset = sprite.texture;
             asset_retarget_handle(asset);
             
@@ -143,18 +225,73 @@ namespace nit
                 asset_release(asset);
             }
         }
-        else if (args.type == GetType<Text>())
+        else if (type == GetType<Text>())
         {
-            auto& asset = entity_get<Text>(args.entity).font;
+            auto& asset = entity_get<Text>(entity).font;
             asset_retarget_handle(asset);
             if (asset_valid(asset) && asset_loaded(asset))
             {
                 asset_release(asset);
             }
         }
+    }
+
+    static ListenerAction on_component_added(const ComponentAddedArgs& args)
+    {
+        component_added(args.type, args.entity);
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_component_removed(const ComponentRemovedArgs& args)
+    {
+        component_removed(args.type, args.entity);
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_components_added(const ComponentsAddedArgs& args)
+    {
+        for (Entity entity : args.entities)
+        {
+            component_added(args.type, entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_components_removed(const ComponentsRemovedArgs& args)
+    {
+        for (Entity entity : args.entities)
+        {
+            component_removed(args.type, entity);
+        }
         return ListenerAction::StayListening;
     }
     
+    static ListenerAction on_deferred_added(const ComponentsAddedArgs& args)
+    {
+        if (args.type == GetType<Sprite>())
+        {
+            sprites_added(args.entities);
+        }
+        return ListenerAction::StayListening;
+    }
+    
+    // Restored components never went through the listeners, their assets may have been released meanwhile.
+    static ListenerAction on_registry_restored()
+    {
+        Array<Entity> sprites;
+        for (Entity entity : entity_view<Sprite>())
+        {
+            sprites.push_back(entity);
+        }
+        sprites_added({ sprites.data(), sprites.size() });
+
+        for (Entity entity : entity_view<Text>())
+        {
+            component_added(GetType<Text>(), entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
     ListenerAction draw()
     {
         clear_screen();
@@ -186,27 +323,62 @@ namespace nit
 
         set_depth_test_enabled(camera.projection == CameraProjection::Perspective);
         
-        begin_scene_2d(camera_proj_view(camera, entity_get<Transform>(main_camera)));
+        Matrix4 proj_view = camera_proj_view(camera, transform_world_matrix(main_camera));
+        
+        // Marks what the spatial index finds inside the view, entities it doesn't know about yet are drawn anyway.
+        Bounds2D view_bounds;
+        bool     culling = calculate_view_bounds(camera, proj_view, view_bounds);
+        draw_stats = {};
+
+        if (culling)
         {
-            for (Entity entity : entity_get_group<Sprite, Transform>().entities)
+            visible_entities.clear();
+            spatial_query_aabb(visible_entities, view_bounds.min, view_bounds.max);
+            visible.assign(engine_get_instance()->entity_registry.next_entity_index, 0);
+            
+            for (Entity entity : visible_entities)
+            {
+                visible[entity_index(entity)] = 1;
+            }
+        }
+
+        auto is_visible = [culling](Entity entity) {
+            if (!culling || visible[entity_index(entity)] || !spatial_contains(entity))
+            {
+                ++draw_stats.drawn;
+                return true;
+            }
+            ++draw_stats.culled;
+            return false;
+        };
+        
+        begin_scene_2d(proj_view);
+        {
+            // The group only owns its pools with pool storage, otherwise components are fetched per entity.
+            EntityGroup& sprite_group = entity_get_group<Sprite, Transform>();
+            const Sprite* sprites     = sprite_group.owning ? entity_group_data<const Sprite>(sprite_group) : nullptr;
+            
+            for (u32 i = 0; i < sprite_group.entities.size(); ++i)
             {
-                auto& transform = entity_get<Transform>(entity);
-                auto& sprite = entity_get<Sprite>(entity);
+                Entity entity = sprite_group.entities[i];
+                const Sprite& sprite = sprites ? sprites[i] : entity_get<const Sprite>(entity);
 
-                if (!sprite.visible || sprite.tint.w <= F32_EPSILON)
+                if (!sprite.visible || sprite.tint.w <= F32_EPSILON || !is_visible(entity))
                 {
                     continue;
                 }
 
-                bool has_texture = asset_valid(sprite.texture); 
+                // Drawing only reads the sprite, the asset calls take a copy of the handle so it isn't marked as changed.
+                AssetHandle texture     = sprite.texture;
+                bool        has_texture = asset_valid(texture); 
 
-                Texture2D* texture_data = has_texture ? asset_get_data<Texture2D>(sprite.texture) : nullptr; 
+                Texture2D* texture_data = has_texture ? asset_get_data<Texture2D>(texture) : nullptr; 
                 
                 if (has_texture)
                 {
-                    if (!asset_loaded(sprite.texture))
+                    if (!asset_loaded(texture))
                     {
-                        asset_retain(sprite.texture);
+                        asset_retain(texture);
                     }
                     
                     Vector2 size = texture_data->size;
@@ -247,77 +419,69 @@ namespace nit
                         vertex_positions = DEFAULT_VERTEX_POSITIONS_2D;
                     }
                     
-                    transform_vertex_positions(vertex_positions, ToMatrix4(transform));
+                    transform_vertex_positions(vertex_positions, transform_world_matrix(entity));
                 }
                 else
                 {
                     vertex_positions = DEFAULT_VERTEX_POSITIONS_2D;
-                    transform_vertex_positions(vertex_positions, ToMatrix4(transform));
+                    transform_vertex_positions(vertex_positions, transform_world_matrix(entity));
                 }
                 
                 fill_vertex_colors(vertex_colors, sprite.tint);
                 draw_quad(texture_data, vertex_positions, vertex_uvs, vertex_colors, (i32) entity);
             }
 
-            for (Entity entity : entity_get_group<Line2D, Transform>().entities)
-            {
-                auto& transform = entity_get<Transform>(entity);
-                auto& line = entity_get<Line2D>(entity);
-
-                if (!line.visible || line.tint.w <= F32_EPSILON )
+            entity_view_each(entity_view<const Line2D, const WorldTransform>(), [&](Entity entity, const Line2D& line, const WorldTransform& world_transform) {
+                if (!line.visible || line.tint.w <= F32_EPSILON || !is_visible(entity))
                 {
-                    continue;
+                    return;
                 }
                 
                 fill_line_2d_vertex_positions(vertex_positions, line.start, line.end, line.thickness);
-                transform_vertex_positions(vertex_positions, ToMatrix4(transform));
+                transform_vertex_positions(vertex_positions, world_transform.matrix);
                 fill_vertex_colors(vertex_colors, line.tint);
                 draw_line_2d(vertex_positions, vertex_colors, (i32) entity);
-            }
+            });
 
-            
-            for (Entity entity : entity_get_group<Text, Transform>().entities)
-            {
-                auto& transform = entity_get<Transform>(entity);
-                auto& text = entity_get<Text>(entity);
-                Font* font_data = asset_valid(text.font) ? asset_get_data<Font>(text.font) : nullptr;
+            entity_view_each(entity_view<const Text, const WorldTransform>(), [&](Entity entity, const Text& text, const WorldTransform& world_transform) {
+                AssetHandle font      = text.font;
+                Font*       font_data = asset_valid(font) ? asset_get_data<Font>(font) : nullptr;
 
-                if (font_data && !asset_loaded(text.font))
+                if (font_data && !asset_loaded(font))
                 {
-                    asset_retain(text.font);
+                    asset_retain(font);
                 }
                 
                 if (!text.visible || text.text.empty() || !font_data)
                 {
-                    continue;
+                    return;
                 }
+
+                // Text has no bounds in the spatial index, it is never culled.
+                ++draw_stats.drawn;
                 
                 draw_text(
                       font_data
                     , text.text
-                    , ToMatrix4(transform)
+                    , world_transform.matrix
                     , text.tint
                     , text.spacing
                     , text.size
                     , (i32) entity
                 );
-            }
-
-            for (Entity entity : entity_get_group<Circle, Transform>().entities)
-            {
-                auto& transform = entity_get<Transform>(entity);
-                auto& circle = entity_get<Circle>(entity);
+            });
 
-                if (!circle.visible || circle.tint.w <= F32_EPSILON)
+            entity_view_each(entity_view<const Circle, const WorldTransform>(), [&](Entity entity, const Circle& circle, const WorldTransform& world_transform) {
+                if (!circle.visible || circle.tint.w <= F32_EPSILON || !is_visible(entity))
                 {
-                    continue;
+                    return;
                 }
                 
                 fill_circle_vertex_positions(vertex_positions, circle.radius);
-                transform_vertex_positions(vertex_positions, ToMatrix4(transform));
+                transform_vertex_positions(vertex_positions, world_transform.matrix);
                 fill_vertex_colors(vertex_colors, circle.tint);
                 draw_circle(vertex_positions, vertex_colors, circle.thickness, circle.fade, (i32) entity);
-            }
+            });
         }
         end_scene_2d();
 
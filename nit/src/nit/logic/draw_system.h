@@ -2,6 +2,14 @@
 
 namespace nit
 {
-    void   register_draw_system();
-    Entity get_main_camera();
+    // Entities drawn and skipped for being out of the camera view in the last frame.
+    struct DrawStats
+    {
+        u32 drawn  = 0;
+        u32 culled = 0;
+    };
+    
+    void             register_draw_system();
+    Entity           get_main_camera();
+    const DrawStats& get_draw_stats();
 }
\ No newline at end of file
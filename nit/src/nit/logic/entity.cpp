@@ -2,137 +2,1287 @@
 
 namespace nit
 {
-#define NIT_CHECK_ENTITY_REGISTRY_CREATED NIT_CHECK(entity_registry)
+#define NIT_CHECK_ENTITY_REGISTRY_CREATED NIT_CHECK(entity_registry_get_instance())
     
-    EntityRegistry* entity_registry = nullptr;
+    static EntityRegistry* default_entity_registry = nullptr;
+
+    // Null until the thread switches registry, so threads started before entity_registry_set_instance (e.g. the job
+    // workers) still follow the default one.
+    static thread_local EntityRegistry* current_entity_registry = nullptr;
 
     void entity_registry_set_instance(EntityRegistry* entity_registry_instance)
     {
-        NIT_CHECK(entity_registry_instance);
-        entity_registry = entity_registry_instance;
+        NIT_CHECK(entity_registry_instance);
+        default_entity_registry = entity_registry_instance;
+        current_entity_registry = nullptr;
+    }
+
+    EntityRegistry* entity_registry_set_current(EntityRegistry* registry)
+    {
+        EntityRegistry* previous = current_entity_registry ? current_entity_registry : default_entity_registry;
+        current_entity_registry  = registry != default_entity_registry ? registry : nullptr;
+        return previous;
+    }
+
+    EntityRegistry* entity_registry_get_instance()
+    {
+        EntityRegistry* entity_registry = current_entity_registry ? current_entity_registry : default_entity_registry;
+        NIT_CHECK(entity_registry);
+        return entity_registry;
+    }
+
+    static thread_local const EntityAccess* entity_access = nullptr;
+
+    const EntityAccess* entity_access_set(const EntityAccess* access)
+    {
+        return std::exchange(entity_access, access);
+    }
+
+    const EntityAccess* entity_access_get()
+    {
+        return entity_access;
+    }
+
+    void entity_access_check(u32 type_index, bool write)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        if (!entity_access || entity_registry != default_entity_registry)
+        {
+            return;
+        }
+
+        bool declared = write ? entity_access->write.test(type_index) : (entity_access->read | entity_access->write).test(type_index);
+        NIT_CHECK_MSG(declared, "System %s touches %s without declaring %s access!", entity_access->name ? entity_access->name : "?",
+            entity_registry->component_pool[type_index - 1].data_pool.type->name.c_str(), write ? "write" : "read");
+    }
+
+    void entity_access_check_structural()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(!entity_access || entity_registry != default_entity_registry, "System %s changes the registry structure, use the command buffer!",
+            entity_access && entity_access->name ? entity_access->name : "?");
+    }
+
+    // Systems share the group map, so creating a group while they run would race with their lookups.
+    void entity_access_check_group()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(!entity_access || entity_registry != default_entity_registry, "System %s creates or destroys a group, declare it with Group<...>!",
+            entity_access && entity_access->name ? entity_access->name : "?");
+    }
+
+    ComponentPool* FindComponentPool(const Type* type)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        for (u32 i = 0; i < entity_registry->next_component_type_index - 1; ++i)
+        {
+            ComponentPool& component_pool = entity_registry->component_pool[i];
+            if (component_pool.data_pool.type == type)
+            {
+                return &component_pool;
+            }
+        }
+        return nullptr;
+    }
+
+    // Pool storage keeps the ticks parallel to the dense slots, they follow the elements when these move.
+    static void component_pool_insert(ComponentPool* component_pool, Entity entity, void* data)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        pool_insert_data_with_id(&component_pool->data_pool, entity_index(entity), data);
+        component_pool->ticks.push_back({ entity_registry->change_tick, entity_registry->change_tick });
+    }
+
+    static void component_pool_delete(ComponentPool* component_pool, Entity entity)
+    {
+        SparseSetDeletion deletion = pool_delete_data(&component_pool->data_pool, entity_index(entity));
+
+        if (deletion.succeded)
+        {
+            component_pool->ticks[deletion.deleted_slot] = component_pool->ticks[deletion.last_slot];
+            component_pool->ticks.pop_back();
+        }
+    }
+
+    static void component_pool_swap(ComponentPool* component_pool, u32 slot_a, u32 slot_b)
+    {
+        pool_swap(&component_pool->data_pool, slot_a, slot_b);
+        std::swap(component_pool->ticks[slot_a], component_pool->ticks[slot_b]);
+    }
+
+    static bool entity_group_contains(EntityGroup& group, Entity entity)
+    {
+        return sparse_is_valid(&group.entity_slots) && sparse_test(&group.entity_slots, entity_index(entity));
+    }
+
+    static void entity_group_insert(EntityGroup& group, Entity entity)
+    {
+        if (!sparse_is_valid(&group.entity_slots))
+        {
+            sparse_load(&group.entity_slots, NIT_ENTITY_GROUP_INITIAL_CAPACITY);
+        }
+        
+        if (sparse_test(&group.entity_slots, entity_index(entity)))
+        {
+            return;
+        }
+        
+        sparse_insert(&group.entity_slots, entity_index(entity));
+        group.entities.push_back(entity);
+    }
+
+    static void entity_group_erase(EntityGroup& group, Entity entity)
+    {
+        if (!entity_group_contains(group, entity))
+        {
+            return;
+        }
+        
+        SparseSetDeletion deletion = sparse_remove(&group.entity_slots, entity_index(entity));
+        group.entities[deletion.deleted_slot] = group.entities[deletion.last_slot];
+        group.entities.pop_back();
+    }
+
+    static void entity_group_swap_slots(EntityGroup& group, u32 slot_a, u32 slot_b)
+    {
+        if (slot_a == slot_b)
+        {
+            return;
+        }
+        
+        std::swap(group.entities[slot_a], group.entities[slot_b]);
+        sparse_swap(&group.entity_slots, slot_a, slot_b);
+    }
+
+    // Outer groups own a subset of the pools of the inner one, so their ranges contain the inner range.
+    static bool owning_group_nests(const EntityGroup& outer, const EntityGroup& inner)
+    {
+        return &outer != &inner && (outer.signature | inner.signature) == inner.signature;
+    }
+
+    static void owning_group_insert(EntityGroup& group, Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 slot = (u32) group.entities.size();
+        
+        for (ComponentPool* component_pool : group.owned_pools)
+        {
+            component_pool_swap(component_pool, pool_index_of(&component_pool->data_pool, entity_index(entity)), slot);
+        }
+
+        // The entity is already in the outer groups, mirror the swap of their pools.
+        for (EntityGroup* outer : entity_registry->owning_groups)
+        {
+            if (owning_group_nests(*outer, group))
+            {
+                entity_group_swap_slots(*outer, sparse_search(&outer->entity_slots, entity_index(entity)), slot);
+            }
+        }
+        
+        entity_group_insert(group, entity);
+    }
+
+    static void owning_group_erase(EntityGroup& group, Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 slot      = sparse_search(&group.entity_slots, entity_index(entity));
+        u32 last_slot = (u32) group.entities.size() - 1;
+        
+        for (ComponentPool* component_pool : group.owned_pools)
+        {
+            component_pool_swap(component_pool, slot, last_slot);
+        }
+
+        for (EntityGroup* outer : entity_registry->owning_groups)
+        {
+            if (owning_group_nests(*outer, group))
+            {
+                entity_group_swap_slots(*outer, slot, last_slot);
+            }
+        }
+        
+        entity_group_erase(group, entity);
+    }
+
+    // std::bitset operators work a machine word at a time, a signature is only a couple of words.
+    static bool entity_signature_contains(const EntitySignature& signature, const EntitySignature& subset)
+    {
+        return (signature & subset) == subset;
+    }
+
+    static EntityGroup& entity_group_register(const EntitySignature& signature)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        auto [it, inserted] = entity_registry->entity_groups.try_emplace(signature);
+        EntityGroup& group = it->second;
+        
+        if (!inserted)
+        {
+            return group;
+        }
+
+        group.signature = signature;
+        u32 component_count = (u32) signature.count();
+
+        // Components only notify the groups requiring them. Keeping the lists sorted by component count
+        // lets nested owning groups be joined from the outermost and left from the innermost.
+        for (u32 type_index = 1; type_index < entity_registry->next_component_type_index; ++type_index)
+        {
+            if (!signature.test(type_index))
+            {
+                continue;
+            }
+
+            Array<EntityGroup*>& groups = entity_registry->component_pool[type_index - 1].groups;
+            auto position = std::upper_bound(groups.begin(), groups.end(), component_count, [](u32 count, const EntityGroup* other) {
+                return count < other->signature.count();
+            });
+            groups.insert(position, &group);
+        }
+        
+        return group;
+    }
+
+    static void entity_group_join(EntityGroup& group, Entity entity)
+    {
+        if (group.owning)
+        {
+            owning_group_insert(group, entity);
+            return;
+        }
+        
+        entity_group_insert(group, entity);
+    }
+
+    // Fills a group created after entities exist. The entities already packed by the nearest nested owning group
+    // go first so they keep their slots, the rest are found testing the signatures.
+    static void entity_group_backfill(EntityGroup& group)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        if (entity_registry->entity_count == 0)
+        {
+            return;
+        }
+
+        if (group.owning)
+        {
+            for (EntityGroup* inner : entity_registry->owning_groups)
+            {
+                if (!owning_group_nests(group, *inner))
+                {
+                    continue;
+                }
+
+                for (Entity entity : inner->entities)
+                {
+                    owning_group_insert(group, entity);
+                }
+                break;
+            }
+        }
+
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            for (const Archetype* archetype : entity_registry->archetypes)
+            {
+                if (!entity_signature_contains(archetype->signature, group.signature))
+                {
+                    continue;
+                }
+
+                for (const ArchetypeChunk& chunk : archetype->chunks)
+                {
+                    for (u32 row = 0; row < chunk.count; ++row)
+                    {
+                        entity_group_insert(group, chunk.entities[row]);
+                    }
+                }
+            }
+            return;
+        }
+
+        for (u32 index = 0; index < entity_registry->next_entity_index; ++index)
+        {
+            const EntitySignature& signature = entity_registry->signatures[index];
+            
+            // Free slots have a cleared signature so they never match.
+            if (!entity_signature_contains(signature, group.signature))
+            {
+                continue;
+            }
+
+            Entity entity = entity_registry->entities[index];
+            if (!entity_group_contains(group, entity))
+            {
+                entity_group_join(group, entity);
+            }
+        }
+    }
+
+    void entity_group_refill(EntityGroup& group)
+    {
+        group.entities.clear();
+        
+        if (sparse_is_valid(&group.entity_slots))
+        {
+            sparse_release(&group.entity_slots);
+        }
+        
+        entity_group_backfill(group);
+    }
+
+    static void entity_component_added(Entity entity, u32 type_index, const EntitySignature& signature)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        for (EntityGroup* group : entity_registry->component_pool[type_index - 1].groups)
+        {
+            if (entity_group_contains(*group, entity) || !entity_signature_contains(signature, group->signature))
+            {
+                continue;
+            }
+
+            entity_group_join(*group, entity);
+        }
+    }
+
+    static void entity_component_removed(Entity entity, u32 type_index)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        Array<EntityGroup*>& groups = entity_registry->component_pool[type_index - 1].groups;
+        
+        for (u32 i = (u32) groups.size(); i-- > 0;)
+        {
+            EntityGroup& group = *groups[i];
+            
+            if (!entity_group_contains(group, entity))
+            {
+                continue;
+            }
+
+            if (group.owning)
+            {
+                owning_group_erase(group, entity);
+            }
+            else
+            {
+                entity_group_erase(group, entity);
+            }
+        }
+    }
+
+    void entity_registry_init()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(entity_registry->max_entities <= MAX_ENTITIES, "Max entities out of range!");
+        entity_registry->component_pool = new ComponentPool[NIT_MAX_COMPONENT_TYPES];
+    }
+
+    static void entity_registry_grow()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 capacity     = entity_registry->entity_capacity;
+        u32 new_capacity = capacity ? std::min(capacity * 2, entity_registry->max_entities) : std::min(1024u, entity_registry->max_entities);
+        
+        Entity*          new_entities   = new Entity[new_capacity];
+        EntitySignature* new_signatures = new EntitySignature[new_capacity];
+        std::copy_n(entity_registry->entities, capacity, new_entities);
+        std::copy_n(entity_registry->signatures, capacity, new_signatures);
+        
+        delete[] entity_registry->entities;
+        delete[] entity_registry->signatures;
+        entity_registry->entities        = new_entities;
+        entity_registry->signatures      = new_signatures;
+        entity_registry->entity_capacity = new_capacity;
+
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            EntityLocation* new_locations = new EntityLocation[new_capacity];
+            std::copy_n(entity_registry->entity_locations, capacity, new_locations);
+            delete[] entity_registry->entity_locations;
+            entity_registry->entity_locations = new_locations;
+        }
+    }
+
+    void FinishEntityRegistry()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        entity_command_buffer_release(entity_registry->commands);
+        
+        for (u32 i = 0; i < entity_registry->next_component_type_index - 1; ++i)
+        {
+            ComponentPool& data = entity_registry->component_pool[i];
+            pool_free(&data.data_pool);
+        }
+
+        entity_registry->owning_groups.clear();
+        for (auto& [signature, group] : entity_registry->entity_groups)
+        {
+            if (sparse_is_valid(&group.entity_slots))
+            {
+                sparse_release(&group.entity_slots);
+            }
+            group.entities.clear();
+        }
+
+        archetype_release_all();
+        entity_hash_index_clear(entity_registry->name_index);
+        entity_hash_index_clear(entity_registry->uuid_index);
+
+        delete[] entity_registry->entities;
+        delete[] entity_registry->signatures;
+        delete[] entity_registry->entity_locations;
+        entity_registry->entities          = nullptr;
+        entity_registry->signatures        = nullptr;
+        entity_registry->entity_locations  = nullptr;
+        entity_registry->entity_capacity   = 0;
+        entity_registry->next_entity_index = 0;
+        entity_registry->free_entity_index = ENTITY_INDEX_MASK;
+        entity_registry->entity_count      = 0;
+    }
+
+    static Entity entity_claim()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        Entity entity;
+        
+        if (entity_registry->free_entity_index != ENTITY_INDEX_MASK)
+        {
+            // Pop the head of the free list, the slot already holds the version to use.
+            u32 index = entity_registry->free_entity_index;
+            entity_registry->free_entity_index = entity_index(entity_registry->entities[index]);
+            entity = entity_compose(index, entity_version(entity_registry->entities[index]));
+        }
+        else
+        {
+            if (entity_registry->next_entity_index == entity_registry->entity_capacity)
+            {
+                entity_registry_grow();
+            }
+            
+            entity = entity_compose(entity_registry->next_entity_index++, 0);
+        }
+        
+        entity_registry->entities[entity_index(entity)] = entity;
+        if (entity_registry->entity_locations)
+        {
+            entity_registry->entity_locations[entity_index(entity)] = {};
+        }
+        ++entity_registry->entity_count;
+        entity_registry->signatures[entity_index(entity)].set(0, true);
+        return entity;
+    }
+
+    static void entity_release(Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 index = entity_index(entity);
+        entity_registry->signatures[index].reset();
+        
+        // Push the slot to the free list, bumping its version so the stale handle stops being valid.
+        // The last version is left to the command buffer placeholders.
+        u32 version = entity_version(entity) + 1;
+        entity_registry->entities[index] = entity_compose(entity_registry->free_entity_index, version == ENTITY_VERSION_MASK ? 0 : version);
+        entity_registry->free_entity_index = index;
+        
+        --entity_registry->entity_count;
+    }
+
+    Entity CreateEntity()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        NIT_CHECK_MSG(entity_registry->entity_count < entity_registry->max_entities, "Entity limit reached!");
+        return entity_claim();
+    }
+
+    void DestroyEntity(Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        NIT_CHECK_MSG(IsEntityValid(entity), "Entity is not valid!");
+
+        for (u32 i = 0; i < entity_registry->next_component_type_index; ++i)
+        {
+            ComponentPool& component_pool = entity_registry->component_pool[i];
+
+            if (!entity_registry->signatures[entity_index(entity)].test(i + 1))
+            {
+                continue;
+            }
+
+            event_broadcast<const ComponentRemovedArgs&>(entity_registry->component_removed_event, {entity, component_pool.data_pool.type});
+            entity_defer_removed(&component_pool, { &entity, 1 });
+
+            // Leave the groups while the component is still in place, owning groups need it.
+            entity_component_removed(entity, component_pool.type_index);
+            
+            if (entity_registry->storage == EntityStorage::Pools)
+            {
+                component_pool_delete(&component_pool, entity);
+            }
+        }
+
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            archetype_move_entity(entity, {});
+        }
+
+        entity_release(entity);
+    }
+
+    void entity_defer_events(u32 type_index, bool deferred)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(type_index != 0 && type_index < entity_registry->next_component_type_index, "Component type is not registered!");
+        ComponentPool& component_pool = entity_registry->component_pool[type_index - 1];
+        component_pool.deferred_events = deferred;
+
+        if (!deferred)
+        {
+            component_pool.deferred_added.clear();
+            component_pool.deferred_removed.clear();
+        }
+    }
+
+    // Leaves the entities sorted by index without repeats, dropping the ones that fail keep.
+    template<typename Func>
+    static void entity_deferred_batch_settle(Array<Entity>& batch, Func&& keep)
+    {
+        std::sort(batch.begin(), batch.end(), [](Entity a, Entity b) { return entity_index(a) != entity_index(b) ? entity_index(a) < entity_index(b) : a < b; });
+        batch.erase(std::unique(batch.begin(), batch.end()), batch.end());
+        std::erase_if(batch, [&keep](Entity entity) { return !keep(entity); });
+    }
+
+    void entity_flush_deferred_events()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        if (entity_registry->flushing_deferred)
+        {
+            return;
+        }
+        
+        entity_registry->flushing_deferred = true;
+        
+        // The batch is swapped out of the pool so listeners can add or remove components while it is delivered.
+        Array<Entity>& batch = entity_registry->deferred_batch;
+        
+        for (u32 type_index = 1; type_index < entity_registry->next_component_type_index; ++type_index)
+        {
+            ComponentPool& component_pool = entity_registry->component_pool[type_index - 1];
+
+            if (!component_pool.deferred_events)
+            {
+                continue;
+            }
+
+            if (!component_pool.deferred_removed.empty())
+            {
+                batch.swap(component_pool.deferred_removed);
+                entity_deferred_batch_settle(batch, [](Entity) { return true; });
+                event_broadcast<const ComponentsRemovedArgs&>(entity_registry->deferred_removed_event, { component_pool.data_pool.type, { batch.data(), batch.size() } });
+                batch.clear();
+            }
+
+            if (!component_pool.deferred_added.empty())
+            {
+                batch.swap(component_pool.deferred_added);
+                entity_deferred_batch_settle(batch, [entity_registry, type_index](Entity entity) {
+                    return IsEntityValid(entity) && entity_registry->signatures[entity_index(entity)].test(type_index);
+                });
+                
+                if (!batch.empty())
+                {
+                    event_broadcast<const ComponentsAddedArgs&>(entity_registry->deferred_added_event, { component_pool.data_pool.type, { batch.data(), batch.size() } });
+                }
+                batch.clear();
+            }
+        }
+
+        entity_registry->flushing_deferred = false;
+    }
+
+    // Creates the entities with the template values and joins the groups, the added events are left to the caller.
+    static Span<const Entity> entity_create_many_silent(u32 count, const EntityTemplate& entity_template)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        NIT_CHECK_MSG(entity_registry->entity_count + count <= entity_registry->max_entities, "Entity limit reached!");
+
+        Array<Entity>& entities = entity_registry->created_entities;
+        entities.resize(count);
+        
+        EntitySignature signature = entity_template.signature;
+        signature.set(0, true);
+        
+        for (Entity& entity : entities)
+        {
+            entity = entity_claim();
+            entity_registry->signatures[entity_index(entity)] = signature;
+        }
+
+        if (entity_template.type_indices.empty() || count == 0)
+        {
+            return { entities.data(), entities.size() };
+        }
+
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            archetype_insert_many(entities.data(), count, entity_template);
+        }
+        else
+        {
+            Array<u32> element_ids(count);
+            for (u32 i = 0; i < count; ++i)
+            {
+                element_ids[i] = entity_index(entities[i]);
+            }
+            
+            for (u32 i = 0; i < entity_template.type_indices.size(); ++i)
+            {
+                ComponentPool& component_pool = entity_registry->component_pool[entity_template.type_indices[i] - 1];
+                pool_insert_many_with_ids(&component_pool.data_pool, element_ids.data(), count, entity_template.values[i]);
+                component_pool.ticks.resize(component_pool.data_pool.sparse_set.count, { entity_registry->change_tick, entity_registry->change_tick });
+            }
+        }
+
+        // Outer owning groups are filled before the nested ones, as when the components are added one at a time.
+        Array<EntityGroup*> groups;
+        for (auto& [group_signature, group] : entity_registry->entity_groups)
+        {
+            if (entity_signature_contains(signature, group_signature))
+            {
+                groups.push_back(&group);
+            }
+        }
+        
+        std::sort(groups.begin(), groups.end(), [](const EntityGroup* a, const EntityGroup* b) {
+            return a->signature.count() < b->signature.count();
+        });
+
+        for (EntityGroup* group : groups)
+        {
+            group->entities.reserve(group->entities.size() + count);
+            
+            for (Entity entity : entities)
+            {
+                entity_group_join(*group, entity);
+            }
+        }
+
+        return { entities.data(), entities.size() };
+    }
+
+    static void entity_broadcast_added_many(Span<const Entity> entities, const EntityTemplate& entity_template)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        for (u32 type_index : entity_template.type_indices)
+        {
+            ComponentsAddedArgs args;
+            args.type     = entity_registry->component_pool[type_index - 1].data_pool.type;
+            args.entities = entities;
+            event_broadcast<const ComponentsAddedArgs&>(entity_registry->components_added_event, args);
+            entity_defer_added(&entity_registry->component_pool[type_index - 1], entities);
+        }
     }
 
-    EntityRegistry* entity_registry_get_instance()
+    Span<const Entity> entity_create_many(u32 count, const EntityTemplate& entity_template)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        return entity_registry;
+        Span<const Entity> entities = entity_create_many_silent(count, entity_template);
+        
+        if (count != 0)
+        {
+            entity_broadcast_added_many(entities, entity_template);
+        }
+        return entities;
     }
 
-    ComponentPool* FindComponentPool(const Type* type)
+    void entity_registry_init_staging(EntityRegistry& staging)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        for (u32 i = 0; i < entity_registry->next_component_type_index; ++i)
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(&staging != entity_registry && !staging.component_pool, "Staging registry already initialized!");
+        staging.max_entities              = entity_registry->max_entities;
+        staging.storage                   = EntityStorage::Pools;
+        staging.component_pool            = new ComponentPool[NIT_MAX_COMPONENT_TYPES];
+        staging.next_component_type_index = entity_registry->next_component_type_index;
+
+        for (u32 i = 0; i < entity_registry->next_component_type_index - 1; ++i)
         {
-            ComponentPool& component_pool = entity_registry->component_pool[i];
-            if (component_pool.data_pool.type == type)
+            const ComponentPool& component_pool = entity_registry->component_pool[i];
+            ComponentPool& staging_pool         = staging.component_pool[i];
+            staging_pool.type_index             = component_pool.type_index;
+            staging_pool.fn_add_to_entity       = component_pool.fn_add_to_entity;
+            staging_pool.fn_remove_from_entity  = component_pool.fn_remove_from_entity;
+            staging_pool.fn_is_in_entity        = component_pool.fn_is_in_entity;
+            staging_pool.fn_get_from_entity     = component_pool.fn_get_from_entity;
+            staging_pool.data_pool.type         = component_pool.data_pool.type;
+            staging_pool.data_pool.elements     = create_array(component_pool.data_pool.type, NIT_COMPONENT_POOL_INITIAL_CAPACITY);
+            sparse_load(&staging_pool.data_pool.sparse_set, NIT_COMPONENT_POOL_INITIAL_CAPACITY);
+        }
+    }
+
+    // Entities sharing a signature are created in one batch, then their components are moved out of the staging pools.
+    void entity_registry_merge(EntityRegistry& staging, Array<Entity>& merged)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(&staging != entity_registry && staging.storage == EntityStorage::Pools, "Invalid staging registry!");
+        NIT_CHECK_MSG(staging.next_component_type_index == entity_registry->next_component_type_index, "Component types registered after the staging registry!");
+
+        merged.assign(staging.next_entity_index, NULL_ENTITY);
+        Map<EntitySignature, Array<u32>> batches;
+
+        for (u32 index = 0; index < staging.next_entity_index; ++index)
+        {
+            if (staging.signatures[index].test(0))
             {
-                return &component_pool;
+                batches[staging.signatures[index]].push_back(index);
             }
         }
-        return nullptr;
+
+        Array<Entity> batch_entities;
+        for (const auto& [signature, indices] : batches)
+        {
+            EntityTemplate entity_template;
+            for (u32 type_index = 1; type_index < entity_registry->next_component_type_index; ++type_index)
+            {
+                if (signature.test(type_index))
+                {
+                    entity_template_set_raw(entity_template, type_index, nullptr);
+                }
+            }
+
+            Span<const Entity> created = entity_create_many_silent((u32) indices.size(), entity_template);
+            batch_entities.assign(created.begin(), created.end());
+
+            for (u32 type_index : entity_template.type_indices)
+            {
+                ComponentPool* component_pool = &entity_registry->component_pool[type_index - 1];
+                Pool* staging_pool            = &staging.component_pool[type_index - 1].data_pool;
+                
+                for (u32 i = 0; i < indices.size(); ++i)
+                {
+                    void* component = entity_registry->storage == EntityStorage::Archetypes
+                        ? archetype_get_component(batch_entities[i], type_index)
+                        : pool_get_raw_data(&component_pool->data_pool, entity_index(batch_entities[i]));
+                    relocate_array(component_pool->data_pool.type, component, pool_get_raw_data(staging_pool, indices[i]), 1);
+                }
+            }
+
+            for (u32 i = 0; i < indices.size(); ++i)
+            {
+                merged[indices[i]] = batch_entities[i];
+            }
+            
+            entity_broadcast_added_many({ batch_entities.data(), batch_entities.size() }, entity_template);
+            entity_template_release(entity_template);
+        }
+
+        entity_registry_finish_staging(staging);
     }
 
-    void entity_registry_init()
+    void entity_registry_finish_staging(EntityRegistry& staging)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
+        NIT_CHECK_MSG(staging.component_pool, "Staging registry not initialized!");
+        EntityRegistry* previous = entity_registry_set_current(&staging);
+        FinishEntityRegistry();
+        delete[] staging.component_pool;
+        staging.component_pool            = nullptr;
+        staging.next_component_type_index = 1;
+        entity_registry_set_current(previous);
+    }
 
-        entity_registry->signatures = new EntitySignature[entity_registry->max_entities];
-        entity_registry->component_pool = new ComponentPool[NIT_MAX_COMPONENT_TYPES];
+    void entity_destroy_many(Span<const Entity> entities)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        for (Entity entity : entities)
+        {
+            NIT_CHECK_MSG(IsEntityValid(entity), "Entity is not valid!");
+        }
+
+        // Component by component, so each pool and the groups requiring it are updated in one go.
+        Array<Entity> with_component;
+        with_component.reserve(entities.size());
         
-        for (u32 i = 0; i < entity_registry->max_entities; ++i)
+        for (u32 type_index = 1; type_index < entity_registry->next_component_type_index; ++type_index)
+        {
+            with_component.clear();
+            for (Entity entity : entities)
+            {
+                if (entity_registry->signatures[entity_index(entity)].test(type_index))
+                {
+                    with_component.push_back(entity);
+                }
+            }
+
+            if (with_component.empty())
+            {
+                continue;
+            }
+
+            ComponentPool& component_pool = entity_registry->component_pool[type_index - 1];
+            
+            ComponentsRemovedArgs args;
+            args.type     = component_pool.data_pool.type;
+            args.entities = { with_component.data(), with_component.size() };
+            event_broadcast<const ComponentsRemovedArgs&>(entity_registry->components_removed_event, args);
+            entity_defer_removed(&component_pool, args.entities);
+
+            for (Entity entity : with_component)
+            {
+                entity_component_removed(entity, type_index);
+                
+                if (entity_registry->storage == EntityStorage::Pools)
+                {
+                    component_pool_delete(&component_pool, entity);
+                }
+            }
+        }
+
+        for (Entity entity : entities)
         {
-            entity_registry->available_entities.push(i);
+            if (entity_registry->storage == EntityStorage::Archetypes)
+            {
+                archetype_move_entity(entity, {});
+            }
+            
+            entity_release(entity);
         }
     }
 
-    void FinishEntityRegistry()
+    void* entity_template_set_raw(EntityTemplate& entity_template, u32 type_index, const void* data)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        for (u32 i = 0; i < entity_registry->next_component_type_index; ++i)
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        NIT_CHECK_MSG(type_index != 0 && type_index < entity_registry->next_component_type_index, "Invalid component type!");
+        const Type* type = entity_registry->component_pool[type_index - 1].data_pool.type;
+        entity_template.signature.set(0, true);
+
+        if (!entity_template.signature.test(type_index))
         {
-            ComponentPool& data = entity_registry->component_pool[i];
-            pool_free(&data.data_pool);
+            entity_template.signature.set(type_index, true);
+            entity_template.type_indices.push_back(type_index);
+            entity_template.values.push_back(create_array(type, 1));
         }
+
+        auto it = std::find(entity_template.type_indices.begin(), entity_template.type_indices.end(), type_index);
+        void* value = entity_template.values[it - entity_template.type_indices.begin()];
+        set_array_raw_data(type, value, 0, const_cast<void*>(data));
+        return value;
     }
 
-    Entity CreateEntity()
+    void entity_template_release(EntityTemplate& entity_template)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        NIT_CHECK_MSG(entity_registry->entity_count < entity_registry->max_entities, "Entity limit reached!");
-        Entity entity = entity_registry->available_entities.front();
-        entity_registry->available_entities.pop();
-        ++entity_registry->entity_count;
-        entity_registry->signatures[entity].set(0, true);
-        return entity;
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        for (u32 i = 0; i < entity_template.type_indices.size(); ++i)
+        {
+            delete_array(entity_registry->component_pool[entity_template.type_indices[i] - 1].data_pool.type, entity_template.values[i]);
+        }
+        
+        entity_template.type_indices.clear();
+        entity_template.values.clear();
+        entity_template.signature.reset();
     }
 
-    void DestroyEntity(Entity entity)
+    bool IsEntityValid(const Entity entity)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        NIT_CHECK_MSG(IsEntityValid(entity), "Entity is not valid!");
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 index = entity_index(entity);
+        return entity != NULL_ENTITY
+            && index < entity_registry->next_entity_index
+            && entity_registry->entities[index] == entity
+            && entity_registry->signatures[index].test(0);
+    }
 
-        for (u32 i = 0; i < entity_registry->next_component_type_index; ++i)
+    void entity_insert_component(ComponentPool* component_pool, Entity entity, void* data)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        EntitySignature& signature = entity_registry->signatures[entity_index(entity)];
+        EntitySignature new_signature = signature;
+        new_signature.set(component_pool->type_index, true);
+        
+        if (entity_registry->storage == EntityStorage::Archetypes)
         {
-            ComponentPool& component_pool = entity_registry->component_pool[i];
+            archetype_move_entity(entity, new_signature, component_pool->type_index, data);
+        }
+        else
+        {
+            component_pool_insert(component_pool, entity, data);
+        }
+        
+        signature = new_signature;
+        entity_component_added(entity, component_pool->type_index, signature);
+    }
+
+    void entity_erase_component(ComponentPool* component_pool, Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        EntitySignature& signature = entity_registry->signatures[entity_index(entity)];
+        signature.set(component_pool->type_index, false);
+        
+        // Leave the groups before deleting the data, owning groups move it out of their range first.
+        entity_component_removed(entity, component_pool->type_index);
+
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            archetype_move_entity(entity, signature);
+        }
+        else
+        {
+            component_pool_delete(component_pool, entity);
+        }
+    }
+
+    void entity_insert_component_many(ComponentPool* component_pool, Span<const Entity> entities, void* const* data)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        u32 type_index = component_pool->type_index;
+
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            for (u32 i = 0; i < entities.size(); ++i)
+            {
+                EntitySignature& signature = entity_registry->signatures[entity_index(entities[i])];
+                EntitySignature new_signature = signature;
+                new_signature.set(type_index, true);
+                archetype_move_entity(entities[i], new_signature, type_index, data[i]);
+                signature = new_signature;
+            }
+        }
+        else
+        {
+            pool_reserve(&component_pool->data_pool, component_pool->data_pool.sparse_set.count + (u32) entities.size());
+            component_pool->ticks.reserve(component_pool->ticks.size() + entities.size());
+            
+            for (u32 i = 0; i < entities.size(); ++i)
+            {
+                component_pool_insert(component_pool, entities[i], data[i]);
+                entity_registry->signatures[entity_index(entities[i])].set(type_index, true);
+            }
+        }
 
-            if (!entity_registry->signatures[entity].test(i + 1))
+        // The groups are sorted from the outermost, as when the components are added one at a time.
+        for (EntityGroup* group : component_pool->groups)
+        {
+            for (Entity entity : entities)
             {
-                continue;
+                if (!entity_group_contains(*group, entity) && entity_signature_contains(entity_registry->signatures[entity_index(entity)], group->signature))
+                {
+                    entity_group_join(*group, entity);
+                }
             }
+        }
+    }
 
-            event_broadcast<const ComponentRemovedArgs&>(entity_registry->component_removed_event, {entity, component_pool.data_pool.type});
-            pool_delete_data(&component_pool.data_pool, entity);
+    void entity_erase_component_many(ComponentPool* component_pool, Span<const Entity> entities)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_structural();
+#endif
+        u32 type_index = component_pool->type_index;
+
+        for (Entity entity : entities)
+        {
+            entity_registry->signatures[entity_index(entity)].set(type_index, false);
+        }
+
+        // Leave the groups from the innermost before deleting the data, owning groups move it out of their range first.
+        Array<EntityGroup*>& groups = component_pool->groups;
+        for (u32 i = (u32) groups.size(); i-- > 0;)
+        {
+            EntityGroup& group = *groups[i];
+            
+            for (Entity entity : entities)
+            {
+                if (!entity_group_contains(group, entity))
+                {
+                    continue;
+                }
+
+                if (group.owning)
+                {
+                    owning_group_erase(group, entity);
+                }
+                else
+                {
+                    entity_group_erase(group, entity);
+                }
+            }
         }
 
-        entity_registry->signatures[entity].reset();
-        entity_registry->available_entities.push(entity);
+        for (Entity entity : entities)
+        {
+            if (entity_registry->storage == EntityStorage::Archetypes)
+            {
+                archetype_move_entity(entity, entity_registry->signatures[entity_index(entity)]);
+            }
+            else
+            {
+                component_pool_delete(component_pool, entity);
+            }
+        }
+    }
+
+    u32 entity_change_tick()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        return entity_registry->change_tick;
+    }
+
+    u32 entity_advance_change_tick()
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        return entity_registry->change_tick++;
+    }
+
+    ComponentTicks* entity_component_ticks(ComponentPool* component_pool, Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        if (entity_registry->storage == EntityStorage::Archetypes)
+        {
+            return archetype_get_ticks(entity, component_pool->type_index);
+        }
         
-        --entity_registry->entity_count;
-        entity_registry->signatures[entity].set(0, false);
+        u32 slot = sparse_search(&component_pool->data_pool.sparse_set, entity_index(entity));
+        return slot != SparseSet::INVALID ? &component_pool->ticks[slot] : nullptr;
+    }
 
-        for (auto& [signature, group] : entity_registry->entity_groups)
+    void* entity_patch(ComponentPool* component_pool, Entity entity)
+    {
+        NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check(component_pool->type_index, true);
+#endif
+        ComponentTicks* ticks = entity_component_ticks(component_pool, entity);
+        NIT_CHECK_MSG(ticks, "Entity doesn't have the component!");
+        ticks->changed = entity_change_tick();
+        return delegate_invoke(component_pool->fn_get_from_entity, entity);
+    }
+
+    u64 entity_hash_index_mix(u64 hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdull;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb9fe1a85ec53ull;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    static void entity_hash_index_place(EntityHashIndex& index, u64 hash, Entity entity)
+    {
+        u64 mask = index.slots.size() - 1;
+        u64 i    = hash & mask;
+
+        while (index.slots[i].entity != NULL_ENTITY)
         {
-            group.entities.erase(entity);
+            i = (i + 1) & mask;
         }
+
+        index.slots[i] = { hash, entity };
     }
 
-    bool IsEntityValid(const Entity entity)
+    void entity_hash_index_insert(EntityHashIndex& index, u64 hash, Entity entity)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        return entity < entity_registry->max_entities && entity_registry->signatures[entity].test(0);
+        NIT_CHECK_MSG(entity != NULL_ENTITY, "Invalid entity!");
+        entity_hash_index_erase(index, entity);
+
+        if ((index.count + 1) * 2 > index.slots.size())
+        {
+            Array<EntityHashIndex::Slot> old_slots(std::max<u64>(index.slots.size() * 2, 64));
+            old_slots.swap(index.slots);
+
+            for (const EntityHashIndex::Slot& slot : old_slots)
+            {
+                if (slot.entity != NULL_ENTITY)
+                {
+                    entity_hash_index_place(index, slot.hash, slot.entity);
+                }
+            }
+        }
+
+        u32 slot = entity_index(entity);
+        if (slot >= index.keys.size())
+        {
+            index.keys.resize(slot + 1);
+            index.indexed.resize(slot + 1);
+        }
+
+        hash = entity_hash_index_mix(hash);
+        entity_hash_index_place(index, hash, entity);
+        index.keys[slot]    = hash;
+        index.indexed[slot] = true;
+        ++index.count;
     }
 
-    void EntitySignatureChanged(Entity entity, EntitySignature new_entity_signature)
+    bool entity_hash_index_erase(EntityHashIndex& index, Entity entity)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        for (auto& [signature, group] : entity_registry->entity_groups)
+        u32 slot = entity_index(entity);
+        if (slot >= index.indexed.size() || !index.indexed[slot])
+        {
+            return false;
+        }
+
+        u64 mask = index.slots.size() - 1;
+        u64 i    = index.keys[slot] & mask;
+
+        // Compared by index, the entity may come back with a newer version.
+        while (entity_index(index.slots[i].entity) != slot)
+        {
+            NIT_CHECK_MSG(index.slots[i].entity != NULL_ENTITY, "Entity missing from its hash index!");
+            i = (i + 1) & mask;
+        }
+
+        // Shift back the slots of the probe chain that would not be reachable across the hole.
+        for (u64 j = (i + 1) & mask; index.slots[j].entity != NULL_ENTITY; j = (j + 1) & mask)
         {
-            if ((signature | new_entity_signature) == new_entity_signature)
+            u64 home = index.slots[j].hash & mask;
+            if (((j - home) & mask) >= ((j - i) & mask))
             {
-                group.entities.insert(entity);
-                continue;
+                index.slots[i] = index.slots[j];
+                i = j;
             }
+        }
+
+        index.slots[i]      = {};
+        index.indexed[slot] = false;
+        --index.count;
+        return true;
+    }
+
+    void entity_hash_index_clear(EntityHashIndex& index)
+    {
+        index.slots.clear();
+        index.keys.clear();
+        index.indexed.clear();
+        index.count = 0;
+    }
+
+    bool entity_filter_passes(const EntityViewFilter& filter, Entity entity)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        for (u32 i = 0; i < filter.term_count; ++i)
+        {
+            const EntityViewFilterTerm& term = filter.terms[i];
+            const ComponentTicks* ticks = entity_component_ticks(&entity_registry->component_pool[term.type_index - 1], entity);
 
-            group.entities.erase(entity);
+            if (!ticks || (term.added ? ticks->added : ticks->changed) <= filter.since)
+            {
+                return false;
+            }
         }
+        
+        return true;
     }
 
-    EntitySignature entity_create_group(const Array<u64>& type_hashes)
+    EntitySignature entity_create_group(const Array<u64>& type_hashes, bool owning)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        NIT_CHECK_MSG(!entity_registry->entity_count, "Create the group before any entity gets created!");
+        EntityRegistry* entity_registry = entity_registry_get_instance();
         EntitySignature group_signature = BuildEntitySignature(type_hashes);
+        bool exists = entity_registry->entity_groups.count(group_signature) != 0;
 
-        if (entity_registry->entity_groups.count(group_signature) != 0)
+        if (exists && (!owning || entity_registry->entity_groups[group_signature].owning || entity_registry->storage == EntityStorage::Archetypes))
         {
             return group_signature;
         }
         
-        EntityGroup* group = &entity_registry->entity_groups[group_signature];
-        group->signature = group_signature;
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_group();
+#endif
+        EntityGroup* group = &entity_group_register(group_signature);
+
+        // Archetype storage already keeps entities with the same components together, owning groups fall back to plain ones.
+        if (!owning || entity_registry->storage == EntityStorage::Archetypes)
+        {
+            entity_group_backfill(*group);
+            return group_signature;
+        }
+
+        // A plain group turning into an owning one gets refilled in pool order.
+        if (exists)
+        {
+            if (sparse_is_valid(&group->entity_slots))
+            {
+                sparse_release(&group->entity_slots);
+            }
+            group->entities.clear();
+        }
+
+        for (EntityGroup* other : entity_registry->owning_groups)
+        {
+            EntitySignature shared = other->signature & group_signature;
+            shared.set(0, false);
+            NIT_CHECK_MSG(shared.none() || owning_group_nests(*other, *group) || owning_group_nests(*group, *other), "Owning groups can only share pools if they nest!");
+        }
+        
+        group->owning = true;
+        for (u32 i = 1; i < entity_registry->next_component_type_index; ++i)
+        {
+            if (group_signature.test(i))
+            {
+                group->owned_pools.push_back(&entity_registry->component_pool[i - 1]);
+            }
+        }
+
+        Array<EntityGroup*>& owning_groups = entity_registry->owning_groups;
+        auto position = std::upper_bound(owning_groups.begin(), owning_groups.end(), group, [](const EntityGroup* a, const EntityGroup* b) {
+            return a->owned_pools.size() < b->owned_pools.size();
+        });
+        owning_groups.insert(position, group);
+        entity_group_backfill(*group);
         return group_signature;
     }
 
+    void entity_destroy_group(EntitySignature signature)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        auto it = entity_registry->entity_groups.find(signature);
+        
+        if (it == entity_registry->entity_groups.end())
+        {
+            return;
+        }
+
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_group();
+#endif
+        EntityGroup* group = &it->second;
+        
+        for (u32 type_index = 1; type_index < entity_registry->next_component_type_index; ++type_index)
+        {
+            if (signature.test(type_index))
+            {
+                std::erase(entity_registry->component_pool[type_index - 1].groups, group);
+            }
+        }
+
+        // Owned pools stay as they are, the remaining nested groups keep their ranges.
+        std::erase(entity_registry->owning_groups, group);
+        
+        if (sparse_is_valid(&group->entity_slots))
+        {
+            sparse_release(&group->entity_slots);
+        }
+        
+        entity_registry->entity_groups.erase(it);
+    }
+
     EntitySignature BuildEntitySignature(const Array<u64>& type_hashes)
     {
         NIT_CHECK_ENTITY_REGISTRY_CREATED
@@ -150,12 +1300,25 @@ namespace nit
 
     EntityGroup& entity_get_group(EntitySignature signature)
     {
-        NIT_CHECK_ENTITY_REGISTRY_CREATED
-        return entity_registry->entity_groups[signature];
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        auto it = entity_registry->entity_groups.find(signature);
+
+        if (it != entity_registry->entity_groups.end())
+        {
+            return it->second;
+        }
+        
+#if NIT_ENTITY_ACCESS_CHECKS
+        entity_access_check_group();
+#endif
+        EntityGroup& group = entity_group_register(signature);
+        entity_group_backfill(group);
+        return group;
     }
 
     void SerializeEntity(Entity entity, YAML::Emitter& emitter)
     {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
         emitter << YAML::Key << "Entity" << YAML::Value << YAML::BeginMap;
         
         for (u8 i = 0; i < entity_registry->next_component_type_index - 1; ++i)
@@ -172,7 +1335,7 @@ namespace nit
 
             emitter << YAML::Key << data_pool.type->name << YAML::Value << YAML::BeginMap;
                 
-            void* raw_data = pool_get_raw_data(&data_pool, entity);
+            void* raw_data = delegate_invoke(component_pool.fn_get_from_entity, entity);
             serialize(data_pool.type, raw_data, emitter);
                 
             emitter << YAML::EndMap;
@@ -185,7 +1348,7 @@ namespace nit
     {
         if (!node)
         {
-            return 0;
+            return NULL_ENTITY;
         }
 
         Entity entity = CreateEntity();
@@ -203,6 +1366,7 @@ namespace nit
             args.entity = entity;
             args.type = component_pool->data_pool.type;
             event_broadcast<const ComponentAddedArgs&>(entity_registry_get_instance()->component_added_event, args);
+            entity_defer_added(component_pool, { &entity, 1 });
         }
         
         return entity;
@@ -4,29 +4,123 @@
     #define NIT_MAX_COMPONENT_TYPES 100
 #endif
 
+#ifndef NIT_COMPONENT_POOL_INITIAL_CAPACITY
+    #define NIT_COMPONENT_POOL_INITIAL_CAPACITY 64
+#endif
+
+#ifndef NIT_ENTITY_GROUP_INITIAL_CAPACITY
+    #define NIT_ENTITY_GROUP_INITIAL_CAPACITY 64
+#endif
+
+#ifndef NIT_ARCHETYPE_CHUNK_SIZE
+    #define NIT_ARCHETYPE_CHUNK_SIZE (16 * 1024)
+#endif
+
+#ifndef NIT_ENTITY_VIEW_MAX_FILTER_TERMS
+    #define NIT_ENTITY_VIEW_MAX_FILTER_TERMS 8
+#endif
+
+#ifndef NIT_ENTITY_ACCESS_CHECKS
+    #ifdef NIT_DEBUG
+        #define NIT_ENTITY_ACCESS_CHECKS 1
+    #else
+        #define NIT_ENTITY_ACCESS_CHECKS 0
+    #endif
+#endif
+
 namespace nit
 {
     inline constexpr u32 NULL_ENTITY = U32_MAX;
     
+    // An entity packs the index of its slot with the version of that slot. The version is bumped each
+    // time the slot gets recycled, so handles to destroyed entities are detected instead of aliasing new ones.
     using Entity = u32;
 
+    inline constexpr u32 ENTITY_INDEX_BITS   = 22;
+    inline constexpr u32 ENTITY_INDEX_MASK   = (1u << ENTITY_INDEX_BITS) - 1;
+    inline constexpr u32 ENTITY_VERSION_MASK = (1u << (32 - ENTITY_INDEX_BITS)) - 1;
+    inline constexpr u32 MAX_ENTITIES        = ENTITY_INDEX_MASK;
+
+    inline u32    entity_index   (Entity entity) { return entity & ENTITY_INDEX_MASK; }
+    inline u32    entity_version (Entity entity) { return entity >> ENTITY_INDEX_BITS; }
+    inline Entity entity_compose (u32 index, u32 version) { return ((version & ENTITY_VERSION_MASK) << ENTITY_INDEX_BITS) | (index & ENTITY_INDEX_MASK); }
+
     // First bit of the signature would be used to know if the entity is valid or not
     using EntitySignature = Bitset<NIT_MAX_COMPONENT_TYPES + 1>;
 
+    struct EntityGroup;
+
+    // Change ticks of a component, compared with the tick a system remembers from its last run.
+    struct ComponentTicks
+    {
+        u32 added   = 0;
+        u32 changed = 0;
+    };
+
     struct ComponentPool
     {
         u32                     type_index  = 0;
         Pool                    data_pool;
+        Array<ComponentTicks>   ticks;  // Pool storage only, parallel to the dense slots of data_pool
+        Array<EntityGroup*>     groups; // Groups requiring the component, sorted by component count
         Delegate<void(Entity)>  fn_add_to_entity;
         Delegate<void(Entity)>  fn_remove_from_entity;
         Delegate<bool(Entity)>  fn_is_in_entity;
         Delegate<void*(Entity)> fn_get_from_entity;
+        bool                    deferred_events = false; // See entity_defer_events
+        Array<Entity>           deferred_added;
+        Array<Entity>           deferred_removed;
     };
     
+    // Entities are kept packed so systems iterate them linearly, the sparse set maps each entity index
+    // to its slot in the array so membership changes are O(1). Order is not preserved on removal.
     struct EntityGroup
     {
-        EntitySignature signature;
-        Set<Entity>     entities;
+        EntitySignature       signature;
+        Array<Entity>         entities;
+        SparseSet             entity_slots;
+        bool                  owning = false; // The owned pools keep the group entities first and in the same order
+        Array<ComponentPool*> owned_pools;
+    };
+
+    inline Span<const Entity> entity_group_span(const EntityGroup& group)
+    {
+        return { group.entities.data(), group.entities.size() };
+    }
+
+    enum class EntityStorage : u8
+    {
+        Pools,      // A pool per component type, indexed by entity
+        Archetypes  // Entities with the same signature share chunks holding a column per component
+    };
+
+    struct ArchetypeChunk
+    {
+        Entity*          entities = nullptr;
+        void**           columns  = nullptr; // Arrays of chunk_capacity constructed components
+        ComponentTicks** ticks    = nullptr; // Per column, chunk_capacity entries
+        u32              count    = 0;
+    };
+
+    // Rows are packed, row r lives in chunks[r / chunk_capacity]. Chunk capacity is the number of rows
+    // that fit NIT_ARCHETYPE_CHUNK_SIZE bytes counting every column plus the entity.
+    struct Archetype
+    {
+        static constexpr u16 NO_COLUMN = U16_MAX;
+        
+        EntitySignature                              signature;
+        Array<u32>                                   type_indices;
+        Array<Type*>                                 types;
+        FixedArray<u16, NIT_MAX_COMPONENT_TYPES + 1> column_of;
+        u32                                          chunk_capacity = 0;
+        u32                                          count          = 0;
+        Array<ArchetypeChunk>                        chunks;
+    };
+
+    struct EntityLocation
+    {
+        u32 archetype = U32_MAX;
+        u32 row       = 0;
     };
 
     struct ComponentAddedArgs
@@ -41,33 +135,172 @@ namespace nit
         Type*  type   = nullptr;
     };
 
-    using ComponentAddedListener   = Listener<const ComponentAddedArgs&>; 
-    using ComponentRemovedListener = Listener<const ComponentRemovedArgs&>; 
-    using ComponentAddedEvent      = Event<const ComponentAddedArgs&>;
-    using ComponentRemovedEvent    = Event<const ComponentRemovedArgs&>;
+    // A command buffer playback overwrote the component in place, e.g. a Set or an Add of a component the entity had.
+    struct ComponentOverwrittenArgs
+    {
+        Entity entity = 0;
+        Type*  type   = nullptr;
+    };
+
+    using ComponentAddedListener       = Listener<const ComponentAddedArgs&>; 
+    using ComponentRemovedListener     = Listener<const ComponentRemovedArgs&>; 
+    using ComponentOverwrittenListener = Listener<const ComponentOverwrittenArgs&>;
+    using ComponentAddedEvent          = Event<const ComponentAddedArgs&>;
+    using ComponentRemovedEvent        = Event<const ComponentRemovedArgs&>;
+    using ComponentOverwrittenEvent    = Event<const ComponentOverwrittenArgs&>;
+
+    // Batched counterparts, broadcast once per component type by entity_create_many and entity_destroy_many.
+    struct ComponentsAddedArgs
+    {
+        Type*              type = nullptr;
+        Span<const Entity> entities;
+    };
+
+    struct ComponentsRemovedArgs
+    {
+        Type*              type = nullptr;
+        Span<const Entity> entities;
+    };
+
+    using ComponentsAddedListener   = Listener<const ComponentsAddedArgs&>;
+    using ComponentsRemovedListener = Listener<const ComponentsRemovedArgs&>;
+    using ComponentsAddedEvent      = Event<const ComponentsAddedArgs&>;
+    using ComponentsRemovedEvent    = Event<const ComponentsRemovedArgs&>;
+
+    // Components given to the entities created by entity_create_many. Each value lives in a one element array
+    // of its type so it can be copied without knowing the type.
+    struct EntityTemplate
+    {
+        EntitySignature signature;
+        Array<u32>      type_indices;
+        Array<void*>    values;
+    };
+
+    enum class EntityCommandType : u8
+    {
+        Destroy,
+        Add,     // Adds the component or overwrites it if the entity already has it
+        Set,     // Overwrites the component, dropped if the entity doesn't have it at playback
+        Remove
+    };
+
+    struct EntityCommand
+    {
+        EntityCommandType type       = EntityCommandType::Destroy;
+        u32               type_index = 0;
+        Entity            entity     = NULL_ENTITY;
+        u32               data_index = 0; // Slot of the payload in the column of the component
+    };
+
+    struct EntityCommandColumn
+    {
+        void* data     = nullptr;
+        u32   count    = 0;
+        u32   capacity = 0;
+    };
+
+    // Records structural changes to apply them later, e.g. while iterating a group or from other threads.
+    // Entities created through the buffer are placeholders until playback, they can be used in the other
+    // commands of the same buffer. Component payloads are copied into a column per component type.
+    struct EntityCommandBuffer
+    {
+        Array<EntityCommand>       commands;
+        Array<EntityCommandColumn> columns;
+        u32                        created_count = 0;
+        std::mutex                 mutex;
+    };
     
+    // Open addressing multimap from a key hash to entities, with linear probing and backward shift deletion. The key
+    // hash of each indexed entity is kept so it can be erased or reindexed without knowing its old key.
+    struct EntityHashIndex
+    {
+        struct Slot
+        {
+            u64    hash   = 0;
+            Entity entity = NULL_ENTITY; // NULL_ENTITY marks an empty slot
+        };
+
+        Array<Slot> slots;   // Power of two sized, at most half full
+        Array<u64>  keys;    // By entity index, hash the entity was indexed with
+        Array<u8>   indexed; // By entity index
+        u32         count = 0;
+    };
+
     struct EntityRegistry
     {
-        Queue<Entity>                     available_entities;
-        EntitySignature*                  signatures;
+        Entity*                           entities          = nullptr; // Free slots store the next free index
+        EntitySignature*                  signatures        = nullptr;
+        u32                               entity_capacity   = 0;
+        u32                               next_entity_index = 0;
+        u32                               free_entity_index = ENTITY_INDEX_MASK;
         u32                               entity_count = 0;
         Map<EntitySignature, EntityGroup> entity_groups;
-        ComponentPool*                    component_pool;
+        Array<EntityGroup*>               owning_groups; // Sorted by owned pool count
+        ComponentPool*                    component_pool = nullptr;
         u32                               next_component_type_index = 1;
         ComponentAddedEvent               component_added_event;
         ComponentRemovedEvent             component_removed_event;
-        u32                               max_entities = 100000;
+        ComponentOverwrittenEvent         component_overwritten_event;
+        ComponentsAddedEvent              components_added_event;
+        ComponentsRemovedEvent            components_removed_event;
+        Array<Entity>                     created_entities; // Result of the last entity_create_many
+        u32                               max_entities = 100000; // Up to MAX_ENTITIES
+        EntityStorage                     storage      = EntityStorage::Pools; // Set before entity_registry_init
+        EntityLocation*                   entity_locations = nullptr;
+        Array<Archetype*>                 archetypes;
+        Map<EntitySignature, u32>         archetype_lookup;
+        EntityCommandBuffer               commands; // Played back by the engine after each stage
+        u32                               change_tick = 1; // Stamped on the components added or written
+        EntityHashIndex                   name_index; // Kept by the Name component, see FindEntityByName
+        EntityHashIndex                   uuid_index; // Kept by the UUID component, see FindEntityByUUID
+        Event<>                           restored_event; // Broadcast by entity_registry_restore
+        ComponentsAddedEvent              deferred_added_event;   // Broadcast by entity_flush_deferred_events
+        ComponentsRemovedEvent            deferred_removed_event; // Broadcast by entity_flush_deferred_events
+        Array<Entity>                     deferred_batch;
+        bool                              flushing_deferred = false;
     };
 
+    // The entity api works on the current registry of the calling thread. Threads start on the default one, given to
+    // entity_registry_set_instance, and can switch to another with entity_registry_set_current, e.g. a loader thread
+    // filling a staging registry. Switching to nullptr goes back to the default, the previous registry is returned.
     void            entity_registry_set_instance(EntityRegistry* entity_registry_instance);
     EntityRegistry* entity_registry_get_instance();
+    EntityRegistry* entity_registry_set_current(EntityRegistry* registry);
+
+    // Components a system declares to touch. Systems of the same stage run in parallel unless one writes what the other
+    // touches, so structural changes on the default registry go through the command buffer instead.
+    struct EntityAccess
+    {
+        const char*     name = nullptr;
+        EntitySignature read;
+        EntitySignature write;
+    };
+
+    inline bool entity_access_conflicts(const EntityAccess& a, const EntityAccess& b)
+    {
+        return (a.write & (b.read | b.write)).any() || (b.write & a.read).any();
+    }
+
+    // With NIT_ENTITY_ACCESS_CHECKS the entity api checks what the calling thread touches against the access set here,
+    // the scheduler sets it while a system runs. Returns the previous one.
+    const EntityAccess* entity_access_set(const EntityAccess* access);
+    const EntityAccess* entity_access_get();
+    void                entity_access_check(u32 type_index, bool write);
+    void                entity_access_check_structural();
+    void                entity_access_check_group();
     
     ComponentPool* FindComponentPool(const Type* type);
+
+    // Assigned by RegisterComponentType, 0 means the component type is not registered.
+    // Lets the templated api reach the pool without hashing the type or scanning the pools.
+    template<typename T>
+    inline u32 component_type_index = 0;
     
     template<typename T>
     ComponentPool* FindComponentPool()
     {
-        return FindComponentPool(GetType<T>());
+        u32 type_index = component_type_index<T>;
+        return type_index != 0 ? &entity_registry_get_instance()->component_pool[type_index - 1] : nullptr;
     }
 
     template<typename T>
@@ -96,6 +329,7 @@ namespace nit
         ComponentPool& component_pool  = entity_registry->component_pool[entity_registry->next_component_type_index - 1];
         component_pool.data_pool.type  = GetType<T>();
         component_pool.type_index      = entity_registry->next_component_type_index;
+        component_type_index<T>        = component_pool.type_index;
 
         void (*fn_add_to_entity)(Entity) = [](Entity entity) {
             component_add_silent<T>(entity);  
@@ -118,38 +352,161 @@ namespace nit
         delegate_bind(component_pool.fn_is_in_entity, fn_is_in_entity);
         delegate_bind(component_pool.fn_get_from_entity, fn_get_from_entity);
         
-        pool_load<T>(&component_pool.data_pool, entity_registry->max_entities, false);
+        // Component storage grows with the live components instead of reserving max_entities upfront.
+        pool_load<T>(&component_pool.data_pool, NIT_COMPONENT_POOL_INITIAL_CAPACITY, false);
         ++entity_registry->next_component_type_index;
     }
 
     template<typename T>
     u32 get_componentTypeIndex()
     {
-        ComponentPool* component_pool = FindComponentPool<T>();
-        NIT_CHECK_MSG(component_pool, "Component type is not registered!");
-        return component_pool->type_index;
+        NIT_CHECK_MSG(component_type_index<T> != 0, "Component type is not registered!");
+        return component_type_index<T>;
     }
     
     void entity_registry_init();
     void FinishEntityRegistry();
+
+    // A staging registry shares the component types of the current one, so it can be filled from any thread and then
+    // merged into the current registry. Merging moves the components, fires the batched added events and releases
+    // the staging registry. merged maps each staging entity index to the new entity, components referencing other
+    // entities have to be remapped by the caller. A staging registry that is not merged is released with
+    // entity_registry_finish_staging.
+    void entity_registry_init_staging(EntityRegistry& staging);
+    void entity_registry_merge(EntityRegistry& staging, Array<Entity>& merged);
+    void entity_registry_finish_staging(EntityRegistry& staging);
     Entity CreateEntity();
     void DestroyEntity(Entity entity);
     bool IsEntityValid(Entity entity);
 
-    void EntitySignatureChanged(Entity entity, EntitySignature new_entity_signature);
+    // Creates the entities with the components of the template. Ids are claimed and pools grown once, and the
+    // groups are updated per group instead of per component. The returned span is valid until the next call.
+    Span<const Entity> entity_create_many(u32 count, const EntityTemplate& entity_template);
+    void               entity_destroy_many(Span<const Entity> entities);
+    
+    void* entity_template_set_raw(EntityTemplate& entity_template, u32 type_index, const void* data);
+    void entity_template_release(EntityTemplate& entity_template);
+
+    template<typename T>
+    void entity_template_set(EntityTemplate& entity_template, const T& data = {})
+    {
+        entity_template_set_raw(entity_template, get_componentTypeIndex<T>(), &data);
+    }
+
+    // Storage side of adding and removing components, also keeps the signature and the groups in sync.
+    void entity_insert_component(ComponentPool* component_pool, Entity entity, void* data);
+    void entity_erase_component(ComponentPool* component_pool, Entity entity);
+
+    // Batches of the above for one component type, data[i] goes to entities[i]. The pool grows once and each group
+    // requiring the component takes the whole batch in one pass. The entities must be unique.
+    void entity_insert_component_many(ComponentPool* component_pool, Span<const Entity> entities, void* const* data);
+    void entity_erase_component_many(ComponentPool* component_pool, Span<const Entity> entities);
+
+    // Types with deferred events also queue their additions and removals, delivered in one batch per type through
+    // deferred_added_event and deferred_removed_event by entity_flush_deferred_events, which the engine calls after each
+    // stage. Batches are sorted by entity index without repeats. Added batches only keep the entities that still have
+    // the component, removed ones can hold destroyed entities, their components are gone by then.
+    void entity_defer_events(u32 type_index, bool deferred = true);
+    void entity_flush_deferred_events();
+
+    template<typename T>
+    void entity_defer_events(bool deferred = true)
+    {
+        entity_defer_events(get_componentTypeIndex<T>(), deferred);
+    }
+
+    inline void entity_defer_added(ComponentPool* component_pool, Span<const Entity> entities)
+    {
+        if (component_pool->deferred_events)
+        {
+            component_pool->deferred_added.insert(component_pool->deferred_added.end(), entities.begin(), entities.end());
+        }
+    }
+
+    inline void entity_defer_removed(ComponentPool* component_pool, Span<const Entity> entities)
+    {
+        if (component_pool->deferred_events)
+        {
+            component_pool->deferred_removed.insert(component_pool->deferred_removed.end(), entities.begin(), entities.end());
+        }
+    }
+
+    u32   archetype_get_or_create(const EntitySignature& signature);
+    void  archetype_move_entity(Entity entity, const EntitySignature& new_signature, u32 added_type_index = 0, void* data = nullptr);
+    void* archetype_get_component(Entity entity, u32 type_index);
+    ComponentTicks* archetype_get_ticks(Entity entity, u32 type_index);
+    void  archetype_insert_many(const Entity* entities, u32 count, const EntityTemplate& entity_template);
+    void  archetype_release_all();
+
+    // Rows of an archetype copied into chunks of its own chunk capacity.
+    struct ArchetypeSnapshot
+    {
+        Array<Type*>          types;
+        u32                   chunk_capacity = 0;
+        u32                   count          = 0;
+        Array<ArchetypeChunk> chunks;
+    };
+
+    void archetype_snapshot(Array<ArchetypeSnapshot>& snapshots);
+    void archetype_restore(const Array<ArchetypeSnapshot>& snapshots);
+    void archetype_snapshot_release(Array<ArchetypeSnapshot>& snapshots);
+
+    // Empties the group and fills it again from the current signatures, owning groups keep their pools partitioned.
+    void entity_group_refill(EntityGroup& group);
+
+    struct EntityGroupSnapshot
+    {
+        Array<Entity> entities;
+        SparseSet     entity_slots;
+    };
+
+    // Copy of the entities, the component storage and the group membership, restored in place to rewind the registry,
+    // e.g. when leaving play mode. Component types have to be the ones there were when the snapshot was taken, groups
+    // created after it are refilled, and handles to entities created after it must be dropped. Components are copied as raw memory when they
+    // are trivially copyable, element by element otherwise.
+    struct EntityRegistrySnapshot
+    {
+        Array<Entity>                             entities;
+        Array<EntitySignature>                    signatures;
+        Array<EntityLocation>                     entity_locations;
+        u32                                       free_entity_index = ENTITY_INDEX_MASK;
+        u32                                       entity_count      = 0;
+        Array<Pool>                               pools;
+        Array<Array<ComponentTicks>>              ticks;
+        Map<EntitySignature, EntityGroupSnapshot> groups;
+        Array<ArchetypeSnapshot>                  archetypes;
+        EntityHashIndex                           name_index;
+        EntityHashIndex                           uuid_index;
+    };
+
+    void entity_registry_snapshot(EntityRegistrySnapshot& snapshot);
+    
+    // Pending commands are dropped and every restored component counts as changed. Systems caching entity state
+    // listen to the restored_event of the registry.
+    void entity_registry_restore(const EntityRegistrySnapshot& snapshot);
+    void entity_registry_snapshot_release(EntityRegistrySnapshot& snapshot);
+
+    template<typename T>
+    T* entity_get_component_data(ComponentPool* component_pool, Entity entity)
+    {
+        if (entity_registry_get_instance()->storage == EntityStorage::Archetypes)
+        {
+            return static_cast<T*>(archetype_get_component(entity, component_pool->type_index));
+        }
+        
+        return pool_get_data<T>(&component_pool->data_pool, entity_index(entity));
+    }
 
     template<typename T>
     T& component_add_silent(Entity entity, const T& data)
     {
         NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
-        NIT_CHECK_MSG(entity_registry_get_instance()->signatures[entity].size() <= NIT_MAX_COMPONENT_TYPES + 1, "Components per entity out of range!");
+        NIT_CHECK_MSG(entity_registry_get_instance()->signatures[entity_index(entity)].size() <= NIT_MAX_COMPONENT_TYPES + 1, "Components per entity out of range!");
         ComponentPool* component_pool = FindComponentPool<T>();
         NIT_CHECK_MSG(component_pool, "Invalid component type!");
-        T* element = pool_insert_data_with_id(&component_pool->data_pool, entity, data);
-        EntitySignature& signature = entity_registry_get_instance()->signatures[entity]; 
-        signature.set(get_componentTypeIndex<T>(), true);
-        EntitySignatureChanged(entity, signature);
-        return *element;
+        entity_insert_component(component_pool, entity, (void*) &data);
+        // Owning groups or archetype moves could have relocated the component.
+        return *entity_get_component_data<T>(component_pool, entity);
     }
 
     EntitySignature BuildEntitySignature(const Array<u64>& type_hashes);
@@ -157,33 +514,33 @@ namespace nit
     template <typename... T>
     EntitySignature BuildEntitySignature()
     {
-        Array<u64> type_hashes = { get_type_hash<T>()... };
-        return BuildEntitySignature(type_hashes);
+        EntitySignature signature;
+        signature.set(0, true);
+        (signature.set(component_type_index<T>, true), ...);
+        return signature;
     }
     
     template<typename T>
         T& entity_add(Entity entity, const T& data = {})
         {
             NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
-            NIT_CHECK_MSG(entity_registry_get_instance()->signatures[entity].size() <= NIT_MAX_COMPONENT_TYPES + 1, "Components per entity out of range!");
+            NIT_CHECK_MSG(entity_registry_get_instance()->signatures[entity_index(entity)].size() <= NIT_MAX_COMPONENT_TYPES + 1, "Components per entity out of range!");
             ComponentPool* component_pool = FindComponentPool<T>();
             NIT_CHECK_MSG(component_pool, "Invalid component type!");
-            T* element = pool_insert_data_with_id(&component_pool->data_pool, entity, data);
-            EntitySignature& signature = entity_registry_get_instance()->signatures[entity]; 
-            signature.set(get_componentTypeIndex<T>(), true);
-            EntitySignatureChanged(entity, signature);
+            entity_insert_component(component_pool, entity, (void*) &data);
             ComponentAddedArgs args;
             args.entity = entity;
             args.type = component_pool->data_pool.type;
             event_broadcast<const ComponentAddedArgs&>(entity_registry_get_instance()->component_added_event, args);
-            return *element;
+            entity_defer_added(component_pool, { &entity, 1 });
+            // Owning groups or archetype moves could have relocated the component.
+            return *entity_get_component_data<T>(component_pool, entity);
         }
         
         template<typename T>
         void entity_remove(Entity entity)
         {
             NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
-            NIT_CHECK_MSG(entity < entity_registry_get_instance()->max_entities, "Entity out of range!");
             ComponentPool* component_pool = FindComponentPool<T>();
             NIT_CHECK_MSG(component_pool, "Invalid component type!");
 
@@ -191,20 +548,39 @@ namespace nit
             args.entity = entity;
             args.type = component_pool->data_pool.type;
             event_broadcast<const ComponentRemovedArgs&>(entity_registry_get_instance()->component_removed_event, args);
+            entity_defer_removed(component_pool, { &entity, 1 });
         
-            pool_delete_data(&component_pool->data_pool, entity);
-            EntitySignature& signature = entity_registry_get_instance()->signatures[entity]; 
-            signature.set(get_componentTypeIndex<T>(), false);
-            EntitySignatureChanged(entity, signature);
+            entity_erase_component(component_pool, entity);
         }
 
+        // A system keeps the tick returned by entity_advance_change_tick at the end of its run and asks for what changed
+        // since then. Mutable access marks the component as changed, like non const view and chunk elements do, so
+        // read through entity_get<const T> and entity_group_data<const T> to leave it untouched.
+        u32             entity_change_tick();
+        u32             entity_advance_change_tick();
+        ComponentTicks* entity_component_ticks(ComponentPool* component_pool, Entity entity);
+
+        // Type erased mutable access, for callers that only have the pool like the editor inspector.
+        void* entity_patch(ComponentPool* component_pool, Entity entity);
+
+        // entity_get<const T> only reads the component, which is what the access checks expect from a Read<T> system.
         template<typename T>
         T& entity_get(Entity entity)
         {
+            using C = std::remove_const_t<T>;
             NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
-            ComponentPool* component_pool = FindComponentPool<T>();
+            ComponentPool* component_pool = FindComponentPool<C>();
             NIT_CHECK_MSG(component_pool, "Invalid component type!");
-            return *pool_get_data<T>(&component_pool->data_pool, entity);
+#if NIT_ENTITY_ACCESS_CHECKS
+            entity_access_check(component_pool->type_index, !std::is_const_v<T>);
+#endif
+            if constexpr (!std::is_const_v<T>)
+            {
+                ComponentTicks* ticks = entity_component_ticks(component_pool, entity);
+                NIT_CHECK_MSG(ticks, "Entity doesn't have the component!");
+                ticks->changed = entity_registry_get_instance()->change_tick;
+            }
+            return *entity_get_component_data<C>(component_pool, entity);
         }
     
         template<typename T>
@@ -213,14 +589,62 @@ namespace nit
             NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
             ComponentPool* component_pool = FindComponentPool<T>();
             NIT_CHECK_MSG(component_pool, "Invalid component type!");
-            return pool_get_data<T>(&component_pool->data_pool, entity);
+            return entity_get_component_data<T>(component_pool, entity);
         }
 
         template<typename T>
         bool entity_has(Entity entity)
         {
             NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
-            return entity_registry_get_instance()->signatures[entity].test(get_componentTypeIndex<T>());
+            return entity_registry_get_instance()->signatures[entity_index(entity)].test(get_componentTypeIndex<T>());
+        }
+
+        // Key hashes are mixed by the index, the callback gets the entities indexed with an equal hash and returns
+        // false to stop. Callers compare the actual keys, different keys can share a hash.
+        void entity_hash_index_insert(EntityHashIndex& index, u64 hash, Entity entity);
+        bool entity_hash_index_erase(EntityHashIndex& index, Entity entity);
+        void entity_hash_index_clear(EntityHashIndex& index);
+        u64  entity_hash_index_mix(u64 hash);
+
+        template<typename Func>
+        void entity_hash_index_find(const EntityHashIndex& index, u64 hash, Func&& func)
+        {
+            if (index.count == 0)
+            {
+                return;
+            }
+
+            u64 mask = index.slots.size() - 1;
+            hash     = entity_hash_index_mix(hash);
+
+            for (u64 i = hash & mask; index.slots[i].entity != NULL_ENTITY; i = (i + 1) & mask)
+            {
+                if (index.slots[i].hash == hash && !func(index.slots[i].entity))
+                {
+                    return;
+                }
+            }
+        }
+
+        // Same as the mutable entity_get, spells out that the component is written.
+        template<typename T>
+        T& entity_patch(Entity entity)
+        {
+            return entity_get<T>(entity);
+        }
+
+        template<typename T>
+        bool entity_changed(Entity entity, u32 since)
+        {
+            NIT_CHECK_MSG(entity_has<T>(entity), "Entity doesn't have the component!");
+            return entity_component_ticks(FindComponentPool<T>(), entity)->changed > since;
+        }
+
+        template<typename T>
+        bool entity_added(Entity entity, u32 since)
+        {
+            NIT_CHECK_MSG(entity_has<T>(entity), "Entity doesn't have the component!");
+            return entity_component_ticks(FindComponentPool<T>(), entity)->added > since;
         }
 
         EntityGroup& entity_get_group(EntitySignature signature);
@@ -228,11 +652,10 @@ namespace nit
         template <typename... T>
         EntityGroup& entity_get_group()
         {
-            Array<u64> type_hashes = { get_type_hash<T>()... };
-            return entity_get_group(BuildEntitySignature(type_hashes));
+            return entity_get_group(BuildEntitySignature<T...>());
         }
 
-        EntitySignature entity_create_group(const Array<u64>& type_hashes);
+        EntitySignature entity_create_group(const Array<u64>& type_hashes, bool owning = false);
     
         template <typename... T>
         EntitySignature entity_create_group()
@@ -240,6 +663,536 @@ namespace nit
             Array<u64> type_hashes = { get_type_hash<T>()... };
             return entity_create_group(type_hashes);
         }
+
+        // Owning groups partition the pools of their components so the first entities.size() elements of each
+        // pool belong to the group, in the order of entities. A pool can be owned by several groups only if they nest,
+        // i.e. the components of one are a subset of the components of the other.
+        template <typename... T>
+        EntitySignature entity_create_owning_group()
+        {
+            Array<u64> type_hashes = { get_type_hash<T>()... };
+            return entity_create_group(type_hashes, true);
+        }
+
+        // Groups can be created and destroyed at any time but while systems run, new ones are filled from the existing
+        // entities. Systems only look groups up, the ones they iterate are created when they are added, see Group<T...>.
+        void entity_destroy_group(EntitySignature signature);
+
+        template <typename... T>
+        void entity_destroy_group()
+        {
+            entity_destroy_group(BuildEntitySignature<T...>());
+        }
+
+        // Packed components of an owning group, element i belongs to group.entities[i]. Mutable access marks the
+        // components of the whole group as changed.
+        template<typename T>
+        T* entity_group_data(const EntityGroup& group)
+        {
+            using C = std::remove_const_t<T>;
+            NIT_CHECK_MSG(group.owning && group.signature.test(get_componentTypeIndex<C>()), "Component type is not owned by the group!");
+#if NIT_ENTITY_ACCESS_CHECKS
+            entity_access_check(get_componentTypeIndex<C>(), !std::is_const_v<T>);
+#endif
+            ComponentPool* component_pool = FindComponentPool<C>();
+
+            if constexpr (!std::is_const_v<T>)
+            {
+                u32 change_tick = entity_registry_get_instance()->change_tick;
+                for (u32 i = 0; i < group.entities.size(); ++i)
+                {
+                    component_pool->ticks[i].changed = change_tick;
+                }
+            }
+            return static_cast<T*>(component_pool->data_pool.elements);
+        }
+
+        // Same as the mutable entity_group_data, spells out that the components are written.
+        template<typename T>
+        T* entity_group_patch(const EntityGroup& group)
+        {
+            return entity_group_data<T>(group);
+        }
+
+        template<typename T>
+        T* entity_chunk_column(const Archetype* archetype, const ArchetypeChunk& chunk, u32 change_tick)
+        {
+            u16 column = archetype->column_of[component_type_index<std::remove_const_t<T>>];
+            
+            if constexpr (!std::is_const_v<T>)
+            {
+                for (u32 row = 0; row < chunk.count; ++row)
+                {
+                    chunk.ticks[column][row].changed = change_tick;
+                }
+            }
+            
+            return static_cast<T*>(chunk.columns[column]);
+        }
+        
+        // Walks the archetypes having all the components chunk by chunk, calling fn(count, entities, T* columns...).
+        // Needs EntityStorage::Archetypes, fn must not add or remove components. Columns requested as non const
+        // are marked as changed.
+        template<typename... T, typename Func>
+        void entity_each_chunk(Func&& fn)
+        {
+            EntityRegistry* entity_registry = entity_registry_get_instance();
+            NIT_CHECK_MSG(entity_registry->storage == EntityStorage::Archetypes, "Chunk iteration needs archetype storage!");
+            EntitySignature signature = BuildEntitySignature<std::remove_const_t<T>...>();
+            
+            for (Archetype* archetype : entity_registry->archetypes)
+            {
+                if ((archetype->signature | signature) != archetype->signature)
+                {
+                    continue;
+                }
+                
+                for (ArchetypeChunk& chunk : archetype->chunks)
+                {
+                    if (chunk.count == 0)
+                    {
+                        break;
+                    }
+                    
+                    fn(chunk.count, static_cast<const Entity*>(chunk.entities), entity_chunk_column<T>(archetype, chunk, entity_registry->change_tick)...);
+                }
+            }
+        }
+    
+    template<typename... T>
+    struct Exclude {};
+
+    template<typename... T>
+    inline constexpr Exclude<T...> exclude = {};
+
+    struct EntityViewFilterTerm
+    {
+        u32  type_index = 0;
+        bool added      = false; // Otherwise changed
+    };
+    
+    // Keeps the entities whose components were added or changed after a tick, see entity_advance_change_tick.
+    struct EntityViewFilter
+    {
+        FixedArray<EntityViewFilterTerm, NIT_ENTITY_VIEW_MAX_FILTER_TERMS> terms      = {};
+        u32                                                                term_count = 0;
+        u32                                                                since      = 0;
+    };
+
+    inline void entity_filter_push(EntityViewFilter& filter, u32 type_index, bool added)
+    {
+        NIT_CHECK_MSG(filter.term_count < NIT_ENTITY_VIEW_MAX_FILTER_TERMS, "Too many filter terms!");
+        filter.terms[filter.term_count++] = { type_index, added };
+    }
+
+    template<typename... T>
+    EntityViewFilter added(u32 since)
+    {
+        EntityViewFilter filter;
+        filter.since = since;
+        (entity_filter_push(filter, get_componentTypeIndex<T>(), true), ...);
+        return filter;
+    }
+
+    template<typename... T>
+    EntityViewFilter changed(u32 since)
+    {
+        EntityViewFilter filter;
+        filter.since = since;
+        (entity_filter_push(filter, get_componentTypeIndex<T>(), false), ...);
+        return filter;
+    }
+
+    inline EntityViewFilter operator|(EntityViewFilter a, const EntityViewFilter& b)
+    {
+        NIT_CHECK_MSG(a.since == b.since, "Combined filters must use the same tick!");
+        for (u32 i = 0; i < b.term_count; ++i)
+        {
+            entity_filter_push(a, b.terms[i].type_index, b.terms[i].added);
+        }
+        return a;
+    }
+
+    bool entity_filter_passes(const EntityViewFilter& filter, Entity entity);
+
+    template<typename... T>
+    struct EntityView;
+
+    template<typename... T>
+    struct EntityViewIterator
+    {
+        const EntityView<T...>* view      = nullptr;
+        u32                     archetype = 0; // Only used with archetype storage
+        u32                     slot      = 0;
+
+        Entity              operator*() const;
+        EntityViewIterator& operator++();
+        bool                operator==(const EntityViewIterator& other) const { return archetype == other.archetype && slot == other.slot; }
+    };
+
+    // Resolves the pools once so iterating doesn't look them up per entity. With pool storage it walks the
+    // smallest pool and tests the signatures, with archetype storage it walks the matching chunks.
+    // Components requested as const are handed out as const, the rest are marked as changed. Adding or removing
+    // the viewed components while iterating is not supported.
+    template<typename... T>
+    struct EntityView
+    {
+        EntityRegistry*                          registry = nullptr;
+        EntitySignature                          included;
+        EntitySignature                          excluded;
+        FixedArray<ComponentPool*, sizeof...(T)> pools    = {};
+        Pool*                                    lead     = nullptr; // Only used with pool storage
+        EntityViewFilter                         filter;
+        bool                                     filtered = false;
+
+        EntityViewIterator<T...> begin() const;
+        EntityViewIterator<T...> end() const;
+    };
+
+    template<typename... T, typename... E>
+    EntityView<T...> entity_view(Exclude<E...> = {}, const EntityViewFilter& filter = {})
+    {
+        static_assert(sizeof...(T) > 0, "Views need at least one component!");
+        EntityView<T...> view;
+        view.registry = entity_registry_get_instance();
+        view.included = BuildEntitySignature<std::remove_const_t<T>...>();
+        view.excluded = BuildEntitySignature<E...>();
+        view.excluded.set(0, false);
+        view.pools    = { FindComponentPool<std::remove_const_t<T>>()... };
+        view.filter   = filter;
+        view.filtered = filter.term_count != 0;
+
+#if NIT_ENTITY_ACCESS_CHECKS
+        (entity_access_check(get_componentTypeIndex<std::remove_const_t<T>>(), !std::is_const_v<T>), ...);
+#endif
+
+        for (ComponentPool* component_pool : view.pools)
+        {
+            NIT_CHECK_MSG(component_pool, "Component type is not registered!");
+            if (!view.lead || component_pool->data_pool.sparse_set.count < view.lead->sparse_set.count)
+            {
+                view.lead = &component_pool->data_pool;
+            }
+        }
+        
+        return view;
+    }
+
+    template<typename... T>
+    EntityView<T...> entity_view(const EntityViewFilter& filter)
+    {
+        return entity_view<T...>(Exclude<>{}, filter);
+    }
+
+    template<typename... T>
+    bool entity_view_matches(const EntityView<T...>& view, const EntitySignature& signature)
+    {
+        return (signature & view.included) == view.included && (signature & view.excluded).none();
+    }
+
+    // Upper bound of the entities in the view, also the range accepted by entity_view_each to split the work in chunks.
+    template<typename... T>
+    u32 entity_view_size_hint(const EntityView<T...>& view)
+    {
+        if (view.registry->storage == EntityStorage::Pools)
+        {
+            return view.lead->sparse_set.count;
+        }
+
+        u32 size = 0;
+        for (const Archetype* archetype : view.registry->archetypes)
+        {
+            size += entity_view_matches(view, archetype->signature) ? archetype->count : 0;
+        }
+        return size;
+    }
+
+    template<typename T, typename... V>
+    constexpr u32 entity_view_component_slot()
+    {
+        constexpr bool same[] = { std::is_same_v<std::remove_const_t<T>, std::remove_const_t<V>>... };
+        for (u32 i = 0; i < sizeof...(V); ++i)
+        {
+            if (same[i])
+            {
+                return i;
+            }
+        }
+        return sizeof...(V);
+    }
+
+    template<typename C, typename... T>
+    C& entity_view_get(const EntityView<T...>& view, Entity entity)
+    {
+        constexpr u32 component_slot = entity_view_component_slot<C, T...>();
+        static_assert(component_slot < sizeof...(T), "Component is not part of the view!");
+        ComponentPool* component_pool = view.pools[component_slot];
+        
+        if (view.registry->storage == EntityStorage::Archetypes)
+        {
+            if constexpr (!std::is_const_v<C>)
+            {
+                archetype_get_ticks(entity, component_pool->type_index)->changed = view.registry->change_tick;
+            }
+            return *static_cast<C*>(archetype_get_component(entity, component_pool->type_index));
+        }
+        
+        Pool* data_pool = &component_pool->data_pool;
+        u32 slot = sparse_search(&data_pool->sparse_set, entity_index(entity));
+        
+        if constexpr (!std::is_const_v<C>)
+        {
+            component_pool->ticks[slot].changed = view.registry->change_tick;
+        }
+        return static_cast<C*>(data_pool->elements)[slot];
+    }
+
+    template<typename C>
+    C& entity_view_element(ComponentPool* component_pool, const Pool* lead, u32 index, u32 lead_slot, u32 change_tick)
+    {
+        Pool* data_pool = &component_pool->data_pool;
+        u32 slot = data_pool == lead ? lead_slot : sparse_search(&data_pool->sparse_set, index);
+        
+        if constexpr (!std::is_const_v<C>)
+        {
+            component_pool->ticks[slot].changed = change_tick;
+        }
+        return static_cast<C*>(data_pool->elements)[slot];
+    }
+
+    template<typename C>
+    C& entity_view_chunk_element(const ArchetypeChunk& chunk, u16 column, u32 chunk_row, u32 change_tick)
+    {
+        if constexpr (!std::is_const_v<C>)
+        {
+            chunk.ticks[column][chunk_row].changed = change_tick;
+        }
+        return static_cast<C*>(chunk.columns[column])[chunk_row];
+    }
+
+    template<typename... T, typename Func, size_t... I>
+    void entity_view_each(const EntityView<T...>& view, u32 begin, u32 end, Func& fn, std::index_sequence<I...>)
+    {
+        EntityRegistry* entity_registry = view.registry;
+        
+        if (entity_registry->storage == EntityStorage::Pools)
+        {
+            const Pool* lead = view.lead;
+            end = std::min(end, lead->sparse_set.count);
+            
+            for (u32 slot = begin; slot < end; ++slot)
+            {
+                u32 index = lead->sparse_set.dense[slot];
+                if (entity_view_matches(view, entity_registry->signatures[index])
+                    && (!view.filtered || entity_filter_passes(view.filter, entity_registry->entities[index])))
+                {
+                    fn(entity_registry->entities[index], entity_view_element<T>(view.pools[I], lead, index, slot, entity_registry->change_tick)...);
+                }
+            }
+            return;
+        }
+
+        // Ranges span the rows of the matching archetypes one after another.
+        u32 offset = 0;
+        for (const Archetype* archetype : entity_registry->archetypes)
+        {
+            if (offset >= end)
+            {
+                break;
+            }
+            
+            if (!entity_view_matches(view, archetype->signature))
+            {
+                continue;
+            }
+
+            u32 first_row = std::max(begin, offset) - offset;
+            u32 last_row  = std::min(end - offset, archetype->count);
+            offset += archetype->count;
+            
+            const u16 columns[] = { archetype->column_of[view.pools[I]->type_index]... };
+            
+            for (u32 row = first_row; row < last_row;)
+            {
+                const ArchetypeChunk& chunk = archetype->chunks[row / archetype->chunk_capacity];
+                u32 chunk_row = row % archetype->chunk_capacity;
+                u32 chunk_end = std::min(chunk.count, chunk_row + (last_row - row));
+                
+                for (; chunk_row < chunk_end; ++chunk_row, ++row)
+                {
+                    if (!view.filtered || entity_filter_passes(view.filter, chunk.entities[chunk_row]))
+                    {
+                        fn(chunk.entities[chunk_row], entity_view_chunk_element<T>(chunk, columns[I], chunk_row, entity_registry->change_tick)...);
+                    }
+                }
+            }
+        }
+    }
+
+    // Calls fn(Entity, T&...) for each entity in the view, optionally restricted to [begin, end) of entity_view_size_hint.
+    template<typename... T, typename Func>
+    void entity_view_each(const EntityView<T...>& view, u32 begin, u32 end, Func&& fn)
+    {
+        entity_view_each(view, begin, end, fn, std::index_sequence_for<T...>{});
+    }
+
+    template<typename... T, typename Func>
+    void entity_view_each(const EntityView<T...>& view, Func&& fn)
+    {
+        entity_view_each(view, 0, U32_MAX, fn, std::index_sequence_for<T...>{});
+    }
+
+    // Calls fn(Entity) for chunks of grain entities on the job system, e.g. over the entities of a group. The jobs work on
+    // the registry and with the access of the caller. fn must only touch the entity it gets and can't make structural
+    // changes, those go through the command buffer.
+    template<typename Func>
+    void entity_parallel_for(Span<const Entity> entities, u32 grain, Func&& fn)
+    {
+        EntityRegistry*     registry = entity_registry_get_instance();
+        const EntityAccess* access   = entity_access_get();
+        job_parallel_for((u32) entities.size(), grain, [&](u32 begin, u32 end) {
+            EntityRegistry*     previous        = entity_registry_set_current(registry);
+            const EntityAccess* previous_access = entity_access_set(access);
+            for (u32 i = begin; i < end; ++i)
+            {
+                fn(entities[i]);
+            }
+            entity_access_set(previous_access);
+            entity_registry_set_current(previous);
+        });
+    }
+
+    // Same as entity_view_each split in chunks of grain entities on the job system, with the same rules as entity_parallel_for.
+    template<typename... T, typename Func>
+    void entity_view_parallel_each(const EntityView<T...>& view, u32 grain, Func&& fn)
+    {
+        const EntityAccess* access = entity_access_get();
+        job_parallel_for(entity_view_size_hint(view), grain, [&](u32 begin, u32 end) {
+            EntityRegistry*     previous        = entity_registry_set_current(view.registry);
+            const EntityAccess* previous_access = entity_access_set(access);
+            entity_view_each(view, begin, end, fn, std::index_sequence_for<T...>{});
+            entity_access_set(previous_access);
+            entity_registry_set_current(previous);
+        });
+    }
+
+    template<typename... T>
+    void entity_view_iterator_settle(EntityViewIterator<T...>& it)
+    {
+        const EntityView<T...>& view = *it.view;
+        EntityRegistry* entity_registry = view.registry;
+        
+        if (entity_registry->storage == EntityStorage::Pools)
+        {
+            for (; it.slot < view.lead->sparse_set.count; ++it.slot)
+            {
+                u32 index = view.lead->sparse_set.dense[it.slot];
+                if (entity_view_matches(view, entity_registry->signatures[index])
+                    && (!view.filtered || entity_filter_passes(view.filter, entity_registry->entities[index])))
+                {
+                    return;
+                }
+            }
+            return;
+        }
+        
+        while (it.archetype < entity_registry->archetypes.size())
+        {
+            const Archetype* archetype = entity_registry->archetypes[it.archetype];
+            
+            if (entity_view_matches(view, archetype->signature))
+            {
+                for (; it.slot < archetype->count; ++it.slot)
+                {
+                    if (!view.filtered || entity_filter_passes(view.filter, archetype->chunks[it.slot / archetype->chunk_capacity].entities[it.slot % archetype->chunk_capacity]))
+                    {
+                        return;
+                    }
+                }
+            }
+            
+            ++it.archetype;
+            it.slot = 0;
+        }
+    }
+
+    template<typename... T>
+    Entity EntityViewIterator<T...>::operator*() const
+    {
+        EntityRegistry* entity_registry = view->registry;
+        
+        if (entity_registry->storage == EntityStorage::Pools)
+        {
+            return entity_registry->entities[view->lead->sparse_set.dense[slot]];
+        }
+
+        const Archetype* current = entity_registry->archetypes[archetype];
+        return current->chunks[slot / current->chunk_capacity].entities[slot % current->chunk_capacity];
+    }
+
+    template<typename... T>
+    EntityViewIterator<T...>& EntityViewIterator<T...>::operator++()
+    {
+        ++slot;
+        entity_view_iterator_settle(*this);
+        return *this;
+    }
+
+    template<typename... T>
+    EntityViewIterator<T...> EntityView<T...>::begin() const
+    {
+        EntityViewIterator<T...> it = { this, 0, 0 };
+        entity_view_iterator_settle(it);
+        return it;
+    }
+
+    template<typename... T>
+    EntityViewIterator<T...> EntityView<T...>::end() const
+    {
+        if (registry->storage == EntityStorage::Pools)
+        {
+            return { this, 0, lead->sparse_set.count };
+        }
+        
+        return { this, (u32) registry->archetypes.size(), 0 };
+    }
+    
+    // Placeholders use the last version, which live entities never get.
+    inline bool entity_is_placeholder(Entity entity)
+    {
+        return entity != NULL_ENTITY && entity_version(entity) == ENTITY_VERSION_MASK;
+    }
+
+    EntityCommandBuffer& entity_commands();
+    Entity               entity_command_create(EntityCommandBuffer& buffer);
+    void                 entity_command_destroy(EntityCommandBuffer& buffer, Entity entity);
+    void                 entity_command_record(EntityCommandBuffer& buffer, EntityCommandType type, Entity entity, u32 type_index, const void* data = nullptr);
+    
+    // Applies the commands and clears the buffer. Commands are sorted by component type and entity so each pool
+    // gets its changes in one batch, and the commands of the same entity and component are coalesced into the last
+    // effective one. Destroys, additions and removals are applied through the bulk paths, so listeners get the batched
+    // components_added_event and components_removed_event. Destroyed entities drop the rest of their commands.
+    // Commands recorded during playback, e.g. by the component listeners, wait for the next playback.
+    void                 entity_command_buffer_playback(EntityCommandBuffer& buffer);
+    void                 entity_command_buffer_release(EntityCommandBuffer& buffer);
+
+    template<typename T>
+    void entity_command_add(EntityCommandBuffer& buffer, Entity entity, const T& data = {})
+    {
+        entity_command_record(buffer, EntityCommandType::Add, entity, get_componentTypeIndex<T>(), &data);
+    }
+
+    template<typename T>
+    void entity_command_set(EntityCommandBuffer& buffer, Entity entity, const T& data)
+    {
+        entity_command_record(buffer, EntityCommandType::Set, entity, get_componentTypeIndex<T>(), &data);
+    }
+
+    template<typename T>
+    void entity_command_remove(EntityCommandBuffer& buffer, Entity entity)
+    {
+        entity_command_record(buffer, EntityCommandType::Remove, entity, get_componentTypeIndex<T>());
+    }
     
     void SerializeEntity(Entity entity, YAML::Emitter& emitter);
     
@@ -0,0 +1,171 @@
+﻿#include "prefab.h"
+#include "components.h"
+
+namespace nit
+{
+    void register_prefab_asset()
+    {
+        asset_register_type<Prefab>({
+              prefab_load
+            , prefab_free
+            , prefab_serialize
+            , prefab_deserialize
+        });
+    }
+
+    // Resolved once here so every instance starts with handles pointing to the asset data.
+    static void prefab_retarget_assets(EntityTemplate& entity_template)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        
+        for (u32 i = 0; i < entity_template.type_indices.size(); ++i)
+        {
+            const Type* type = entity_registry->component_pool[entity_template.type_indices[i] - 1].data_pool.type;
+
+            if (type == GetType<Sprite>())
+            {
+                asset_retarget_handle(static_cast<Sprite*>(entity_template.values[i])->texture);
+            }
+            else if (type == GetType<Text>())
+            {
+                asset_retarget_handle(static_cast<Text*>(entity_template.values[i])->font);
+            }
+        }
+    }
+
+    void prefab_serialize(const Prefab* prefab, YAML::Emitter& emitter)
+    {
+        emitter << YAML::Key << "Components" << YAML::Value;
+        
+        if (!prefab_loaded(prefab))
+        {
+            // Nothing was built from the cached components, write them back as they were read.
+            const YAML::Node node = YAML::Load(prefab->cached_prefab);
+            
+            if (node["Components"])
+            {
+                emitter << node["Components"];
+            }
+            else
+            {
+                emitter << YAML::BeginMap << YAML::EndMap;
+            }
+            return;
+        }
+
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        const EntityTemplate& entity_template = prefab->entity_template;
+        emitter << YAML::BeginMap;
+        
+        for (u32 i = 0; i < entity_template.type_indices.size(); ++i)
+        {
+            Type* type = entity_registry->component_pool[entity_template.type_indices[i] - 1].data_pool.type;
+
+            if (!type->fn_invoke_serialize)
+            {
+                continue;
+            }
+            
+            emitter << YAML::Key << type->name << YAML::Value << YAML::BeginMap;
+            serialize(type, entity_template.values[i], emitter);
+            emitter << YAML::EndMap;
+        }
+        
+        emitter << YAML::EndMap;
+    }
+
+    void prefab_deserialize(Prefab* prefab, const YAML::Node& node)
+    {
+        StringStream ss;
+        ss << node;
+        prefab->cached_prefab = ss.str();
+    }
+
+    void prefab_load(Prefab* prefab)
+    {
+        NIT_CHECK(prefab);
+        entity_template_release(prefab->entity_template);
+        prefab->entity_template.signature.set(0, true);
+        
+        const YAML::Node node = YAML::Load(prefab->cached_prefab);
+
+        for (const auto& component_node : node["Components"])
+        {
+            Type* type = GetType(component_node.first.as<String>());
+            NIT_CHECK_MSG(type, "Unknown prefab component type!");
+
+            // Instances get their own ids.
+            if (type == GetType<UUID>())
+            {
+                continue;
+            }
+            
+            ComponentPool* component_pool = FindComponentPool(type);
+            NIT_CHECK_MSG(component_pool, "Prefab component type is not registered!");
+            
+            void* value = entity_template_set_raw(prefab->entity_template, component_pool->type_index, nullptr);
+            deserialize(type, value, component_node.second);
+        }
+
+        prefab_retarget_assets(prefab->entity_template);
+    }
+
+    void prefab_free(Prefab* prefab)
+    {
+        NIT_CHECK(prefab);
+        entity_template_release(prefab->entity_template);
+    }
+
+    bool prefab_loaded(const Prefab* prefab)
+    {
+        return prefab->entity_template.signature.test(0);
+    }
+
+    void prefab_set_entity(Prefab* prefab, Entity entity)
+    {
+        NIT_CHECK(prefab);
+        NIT_CHECK_MSG(IsEntityValid(entity), "Invalid entity!");
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        
+        entity_template_release(prefab->entity_template);
+        prefab->entity_template.signature.set(0, true);
+
+        for (u32 i = 0; i < entity_registry->next_component_type_index - 1; ++i)
+        {
+            ComponentPool& component_pool = entity_registry->component_pool[i];
+
+            // Instances get their own ids.
+            if (component_pool.data_pool.type == GetType<UUID>() || !entity_registry->signatures[entity_index(entity)].test(component_pool.type_index))
+            {
+                continue;
+            }
+
+            entity_template_set_raw(prefab->entity_template, component_pool.type_index, delegate_invoke(component_pool.fn_get_from_entity, entity));
+        }
+
+        YAML::Emitter emitter;
+        emitter << YAML::BeginMap;
+        prefab_serialize(prefab, emitter);
+        emitter << YAML::EndMap;
+        prefab->cached_prefab = emitter.c_str();
+    }
+
+    Span<const Entity> prefab_instantiate(const Prefab* prefab, u32 count)
+    {
+        NIT_CHECK(prefab);
+        NIT_CHECK_MSG(prefab_loaded(prefab), "Prefab is not loaded!");
+        return entity_create_many(count, prefab->entity_template);
+    }
+
+    Span<const Entity> prefab_instantiate(AssetHandle& prefab_asset, u32 count)
+    {
+        NIT_CHECK_MSG(asset_valid(prefab_asset), "Invalid prefab asset!");
+        
+        if (!asset_loaded(prefab_asset))
+        {
+            asset_load(prefab_asset);
+        }
+        
+        return prefab_instantiate(asset_get_data<Prefab>(prefab_asset), count);
+    }
+}
@@ -0,0 +1,24 @@
+﻿#pragma once
+#include "entity.h"
+#include "nit/core/asset.h"
+
+namespace nit
+{
+    // The components are deserialized once on load into a template, instancing copies the template values
+    // without going through YAML or looking types up by name.
+    struct Prefab
+    {
+        String         cached_prefab;
+        EntityTemplate entity_template;
+    };
+    
+    void               register_prefab_asset();
+    void               prefab_serialize(const Prefab* prefab, YAML::Emitter& emitter);
+    void               prefab_deserialize(Prefab* prefab, const YAML::Node& node);
+    void               prefab_load(Prefab* prefab);
+    void               prefab_free(Prefab* prefab);
+    bool               prefab_loaded(const Prefab* prefab);
+    void               prefab_set_entity(Prefab* prefab, Entity entity);
+    Span<const Entity> prefab_instantiate(const Prefab* prefab, u32 count = 1);
+    Span<const Entity> prefab_instantiate(AssetHandle& prefab_asset, u32 count = 1);
+}
@@ -4,6 +4,18 @@
 
 namespace nit
 {
+    struct SceneStaging
+    {
+        EntityRegistry registry;
+        JobCounter     counter;
+        String         source; // The job doesn't touch the scene, it can move in the asset pool meanwhile
+        Array<Entity>  entities;
+    };
+
+    static bool load_async = false;
+
+    static ListenerAction scene_merge_staged();
+    
     void register_scene_asset()
     {
         asset_register_type<Scene>({
@@ -12,6 +24,8 @@ namespace nit
             , scene_serialize
             , scene_deserialize
         });
+
+        engine_event(Stage::Update) += EngineListener::create(scene_merge_staged);
     }
 
     static void serialize_entities(const Scene* scene, YAML::Emitter& emitter)
@@ -24,6 +38,27 @@ namespace nit
         emitter << YAML::EndMap;
     }
     
+    static void deserialize_entities(const String& source, Array<Entity>& entities)
+    {
+        const YAML::Node node = YAML::Load(source);
+        const YAML::Node& entities_node = node["Entities"];
+
+        for (const auto& entity_node : entities_node)
+        {
+            const YAML::Node& entity_node_value = entity_node.second;
+            Entity entity = DeserializeEntity(entity_node_value);
+            entities.push_back(entity);
+        }
+    }
+
+    static void scene_stage_entities(void* data, u32, u32)
+    {
+        SceneStaging* staging = static_cast<SceneStaging*>(data);
+        EntityRegistry* previous = entity_registry_set_current(&staging->registry);
+        deserialize_entities(staging->source, staging->entities);
+        entity_registry_set_current(previous);
+    }
+
     void scene_serialize(const Scene* scene, YAML::Emitter& emitter)
     {
         // More items to serialize
@@ -39,6 +74,16 @@ namespace nit
     
     void scene_load(Scene* scene)
     {
+        if (load_async)
+        {
+            NIT_CHECK_MSG(scene->entities.empty() && !scene->staging, "Scene entities already loaded!");
+            scene->staging         = new SceneStaging();
+            scene->staging->source = scene->cached_scene;
+            entity_registry_init_staging(scene->staging->registry);
+            job_run({ scene_stage_entities, scene->staging, 0, 1, &scene->staging->counter });
+            return;
+        }
+        
         scene_load_entities(scene);
     }
 
@@ -63,6 +108,14 @@ namespace nit
     void scene_free_entities(Scene* scene)
     {
         NIT_CHECK(scene);
+        if (scene->staging)
+        {
+            job_wait(scene->staging->counter);
+            entity_registry_finish_staging(scene->staging->registry);
+            delete scene->staging;
+            scene->staging = nullptr;
+        }
+        
         if (!scene->entities.empty())
         {
             for (Entity entity : scene->entities)
@@ -76,14 +129,48 @@ namespace nit
     void scene_load_entities(Scene* scene)
     {
         NIT_CHECK(scene);
-        const YAML::Node node = YAML::Load(scene->cached_scene);
-        const YAML::Node& entities_node = node["Entities"];
+        deserialize_entities(scene->cached_scene, scene->entities);
+    }
 
-        for (const auto& entity_node : entities_node)
+    static ListenerAction scene_merge_staged()
+    {
+        AssetPool* pool = asset_get_pool<Scene>();
+        Scene* scenes = static_cast<Scene*>(pool->data_pool.elements);
+        Array<Entity> merged;
+
+        for (u32 i = 0; i < pool->data_pool.sparse_set.count; ++i)
         {
-            const YAML::Node& entity_node_value = entity_node.second;
-            Entity entity = DeserializeEntity(entity_node_value);
-            scene->entities.push_back(entity);
+            Scene* scene = &scenes[i];
+            
+            if (!scene->staging || scene->staging->counter.pending.load(std::memory_order_acquire) != 0)
+            {
+                continue;
+            }
+
+            entity_registry_merge(scene->staging->registry, merged);
+            
+            for (Entity entity : scene->staging->entities)
+            {
+                scene->entities.push_back(merged[entity_index(entity)]);
+            }
+            
+            delete scene->staging;
+            scene->staging = nullptr;
         }
+        
+        return ListenerAction::StayListening;
+    }
+
+    void scene_load_async(AssetHandle& scene_asset)
+    {
+        load_async = true;
+        asset_load(scene_asset);
+        load_async = false;
+    }
+
+    bool scene_entities_staging(const Scene* scene)
+    {
+        NIT_CHECK(scene);
+        return scene->staging != nullptr;
     }
 }
@@ -1,12 +1,16 @@
 ﻿#pragma once
 #include "entity.h"
+#include "nit/core/asset.h"
 
 namespace nit
 {
+    struct SceneStaging;
+    
     struct Scene
     {
         String cached_scene;
         Array<Entity> entities;
+        SceneStaging* staging = nullptr; // Entities loading in the background, see scene_load_async
     };
     
     void register_scene_asset();
@@ -18,4 +22,10 @@ namespace nit
     void scene_save_entities(Scene* scene);
     void scene_free_entities(Scene* scene);
     void scene_load_entities(Scene* scene);
+
+    // Loads the scene without deserializing its entities on the calling thread. A job fills a staging registry with
+    // them and they are merged into the current registry at the start of the first Stage::Update after it finished.
+    // See entity_registry_init_staging.
+    void scene_load_async(AssetHandle& scene_asset);
+    bool scene_entities_staging(const Scene* scene);
 }
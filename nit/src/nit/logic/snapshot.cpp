@@ -0,0 +1,175 @@
+﻿#include "entity.h"
+
+namespace nit
+{
+    void entity_registry_snapshot(EntityRegistrySnapshot& snapshot)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        entity_registry_snapshot_release(snapshot);
+
+        u32 entity_slots = entity_registry->next_entity_index;
+        snapshot.entities.assign(entity_registry->entities, entity_registry->entities + entity_slots);
+        snapshot.signatures.assign(entity_registry->signatures, entity_registry->signatures + entity_slots);
+        snapshot.free_entity_index = entity_registry->free_entity_index;
+        snapshot.entity_count      = entity_registry->entity_count;
+
+        if (entity_registry->storage == EntityStorage::Pools)
+        {
+            u32 pool_count = entity_registry->next_component_type_index - 1;
+            snapshot.pools.resize(pool_count);
+            snapshot.ticks.resize(pool_count);
+
+            for (u32 i = 0; i < pool_count; ++i)
+            {
+                pool_copy(&snapshot.pools[i], &entity_registry->component_pool[i].data_pool);
+                snapshot.ticks[i] = entity_registry->component_pool[i].ticks;
+            }
+        }
+        else
+        {
+            snapshot.entity_locations.assign(entity_registry->entity_locations, entity_registry->entity_locations + entity_slots);
+            archetype_snapshot(snapshot.archetypes);
+        }
+
+        for (auto& [signature, group] : entity_registry->entity_groups)
+        {
+            EntityGroupSnapshot& group_snapshot = snapshot.groups[signature];
+            group_snapshot.entities = group.entities;
+
+            if (sparse_is_valid(&group.entity_slots))
+            {
+                sparse_copy(&group_snapshot.entity_slots, &group.entity_slots);
+            }
+        }
+
+        snapshot.name_index = entity_registry->name_index;
+        snapshot.uuid_index = entity_registry->uuid_index;
+    }
+
+    void entity_registry_restore(const EntityRegistrySnapshot& snapshot)
+    {
+        EntityRegistry* entity_registry = entity_registry_get_instance();
+        u32 entity_slots = (u32) snapshot.entities.size();
+        NIT_CHECK_MSG(entity_slots <= entity_registry->entity_capacity, "Snapshot from another registry!");
+        
+        entity_command_buffer_release(entity_registry->commands);
+        entity_registry->created_entities.clear();
+
+        // Slots claimed after the snapshot go back to unused, entity_claim expects them without components.
+        std::copy_n(snapshot.entities.data(), entity_slots, entity_registry->entities);
+        std::copy_n(snapshot.signatures.data(), entity_slots, entity_registry->signatures);
+        std::fill(entity_registry->signatures + entity_slots, entity_registry->signatures + entity_registry->next_entity_index, EntitySignature{});
+        entity_registry->next_entity_index = entity_slots;
+        entity_registry->free_entity_index = snapshot.free_entity_index;
+        entity_registry->entity_count      = snapshot.entity_count;
+
+        u32 change_tick = entity_registry->change_tick;
+
+        if (entity_registry->storage == EntityStorage::Pools)
+        {
+            u32 pool_count = entity_registry->next_component_type_index - 1;
+            NIT_CHECK_MSG(snapshot.pools.size() == pool_count, "Component types registered after the snapshot!");
+
+            for (u32 i = 0; i < pool_count; ++i)
+            {
+                ComponentPool& component_pool = entity_registry->component_pool[i];
+                pool_copy(&component_pool.data_pool, &snapshot.pools[i]);
+                component_pool.ticks = snapshot.ticks[i];
+
+                for (u32 slot = 0; slot < component_pool.data_pool.sparse_set.count; ++slot)
+                {
+                    component_pool.ticks[slot].changed = change_tick;
+                }
+            }
+        }
+        else
+        {
+            std::copy_n(snapshot.entity_locations.data(), entity_slots, entity_registry->entity_locations);
+            archetype_restore(snapshot.archetypes);
+
+            for (Archetype* archetype : entity_registry->archetypes)
+            {
+                for (ArchetypeChunk& chunk : archetype->chunks)
+                {
+                    for (u32 column = 0; column < archetype->types.size(); ++column)
+                    {
+                        for (u32 row = 0; row < chunk.count; ++row)
+                        {
+                            chunk.ticks[column][row].changed = change_tick;
+                        }
+                    }
+                }
+            }
+        }
+
+        Array<EntityGroup*> created_groups;
+        
+        for (auto& [signature, group] : entity_registry->entity_groups)
+        {
+            auto it = snapshot.groups.find(signature);
+
+            if (it == snapshot.groups.end())
+            {
+                created_groups.push_back(&group);
+                continue;
+            }
+            
+            const EntityGroupSnapshot& group_snapshot = it->second;
+            group.entities = group_snapshot.entities;
+
+            // The slots are loaded with the first member.
+            if (group_snapshot.entity_slots.max != 0)
+            {
+                sparse_copy(&group.entity_slots, &group_snapshot.entity_slots);
+            }
+            else if (sparse_is_valid(&group.entity_slots))
+            {
+                sparse_release(&group.entity_slots);
+            }
+        }
+
+        // Refilled once the others are restored, nested owning groups first so the outer ones keep their slots.
+        std::sort(created_groups.begin(), created_groups.end(), [](const EntityGroup* a, const EntityGroup* b) {
+            return a->owned_pools.size() < b->owned_pools.size();
+        });
+        
+        for (EntityGroup* group : created_groups)
+        {
+            entity_group_refill(*group);
+        }
+
+        entity_registry->name_index = snapshot.name_index;
+        entity_registry->uuid_index = snapshot.uuid_index;
+
+        // Queued events refer to the state left behind, restored_event listeners start over from the restored one.
+        for (u32 i = 0; i < entity_registry->next_component_type_index - 1; ++i)
+        {
+            entity_registry->component_pool[i].deferred_added.clear();
+            entity_registry->component_pool[i].deferred_removed.clear();
+        }
+
+        event_broadcast(entity_registry->restored_event);
+    }
+
+    void entity_registry_snapshot_release(EntityRegistrySnapshot& snapshot)
+    {
+        for (Pool& pool : snapshot.pools)
+        {
+            if (pool.type)
+            {
+                pool_free(&pool);
+            }
+        }
+
+        for (auto& [signature, group_snapshot] : snapshot.groups)
+        {
+            if (sparse_is_valid(&group_snapshot.entity_slots))
+            {
+                sparse_release(&group_snapshot.entity_slots);
+            }
+        }
+
+        archetype_snapshot_release(snapshot.archetypes);
+        snapshot = {};
+    }
+}
@@ -0,0 +1,539 @@
+﻿#include "spatial_system.h"
+#include "nit/core/engine.h"
+#include "nit/logic/components.h"
+#include "nit/logic/transform_system.h"
+
+namespace nit
+{
+    static SpatialIndex spatial;
+    
+    ListenerAction spatial_start();
+    ListenerAction spatial_end();
+    ListenerAction spatial_pre_draw();
+    
+    static ListenerAction on_component_added(const ComponentAddedArgs& args);
+    static ListenerAction on_component_removed(const ComponentRemovedArgs& args);
+    static ListenerAction on_components_added(const ComponentsAddedArgs& args);
+    static ListenerAction on_components_removed(const ComponentsRemovedArgs& args);
+    static ListenerAction on_registry_restored();
+
+    void register_spatial_system()
+    {
+        engine_event(Stage::Start)   += EngineListener::create(spatial_start);
+        engine_event(Stage::End)     += EngineListener::create(spatial_end);
+        engine_event(Stage::PreDraw) += EngineListener::create(spatial_pre_draw);
+    }
+
+    ListenerAction spatial_start()
+    {
+        entity_registry_get_instance()->component_added_event    += ComponentAddedListener::create(on_component_added);
+        entity_registry_get_instance()->component_removed_event  += ComponentRemovedListener::create(on_component_removed);
+        entity_registry_get_instance()->components_added_event   += ComponentsAddedListener::create(on_components_added);
+        entity_registry_get_instance()->components_removed_event += ComponentsRemovedListener::create(on_components_removed);
+        entity_registry_get_instance()->restored_event           += Listener<>::create(on_registry_restored);
+        spatial.full_scan = true;
+        return ListenerAction::StayListening;
+    }
+
+    ListenerAction spatial_end()
+    {
+        entity_registry_get_instance()->component_added_event    -= ComponentAddedListener::create(on_component_added);
+        entity_registry_get_instance()->component_removed_event  -= ComponentRemovedListener::create(on_component_removed);
+        entity_registry_get_instance()->components_added_event   -= ComponentsAddedListener::create(on_components_added);
+        entity_registry_get_instance()->components_removed_event -= ComponentsRemovedListener::create(on_components_removed);
+        entity_registry_get_instance()->restored_event           -= Listener<>::create(on_registry_restored);
+        spatial = {};
+        return ListenerAction::StayListening;
+    }
+
+    // Runs after the transform system, the world matrices are up to date.
+    ListenerAction spatial_pre_draw()
+    {
+        spatial_update();
+        return ListenerAction::StayListening;
+    }
+
+    static bool spatial_is_shape(Type* type)
+    {
+        return type == GetType<Sprite>() || type == GetType<Circle>() || type == GetType<Line2D>();
+    }
+
+    static i32 spatial_cell_coord(f32 value)
+    {
+        return (i32) std::floor(value / spatial.cell_size);
+    }
+
+    static u64 spatial_cell_key(i32 x, i32 y)
+    {
+        return ((u64) (u32) x << 32) | (u64) (u32) y;
+    }
+
+    static u32 spatial_bucket(u64 cell)
+    {
+        u32 x = (u32) (cell >> 32), y = (u32) cell;
+        return ((x * 73856093u) ^ (y * 19349663u)) & (u32) (spatial.bucket_start.size() - 2);
+    }
+
+    static void spatial_place(SpatialProxy& proxy)
+    {
+        proxy.large = proxy.bounds.max.x - proxy.bounds.min.x > spatial.cell_size || proxy.bounds.max.y - proxy.bounds.min.y > spatial.cell_size;
+        proxy.cell  = proxy.large ? 0 : spatial_cell_key(
+              spatial_cell_coord((proxy.bounds.min.x + proxy.bounds.max.x) * .5f)
+            , spatial_cell_coord((proxy.bounds.min.y + proxy.bounds.max.y) * .5f));
+    }
+
+    // Counting sort of the proxies by bucket, the bucket count is the next power of two of the proxy count.
+    static void spatial_layout()
+    {
+        if (!spatial.layout_dirty)
+        {
+            return;
+        }
+
+        u32 bucket_count = 16;
+        while (bucket_count < spatial.proxies.size())
+        {
+            bucket_count *= 2;
+        }
+
+        spatial.bucket_start.assign(bucket_count + 1, 0);
+        spatial.large.clear();
+
+        for (const SpatialProxy& proxy : spatial.proxies)
+        {
+            if (!proxy.large)
+            {
+                ++spatial.bucket_start[spatial_bucket(proxy.cell) + 1];
+            }
+        }
+
+        for (u32 i = 1; i <= bucket_count; ++i)
+        {
+            spatial.bucket_start[i] += spatial.bucket_start[i - 1];
+        }
+        spatial.sorted.resize(spatial.bucket_start[bucket_count]);
+
+        Array<u32> cursor(spatial.bucket_start.begin(), spatial.bucket_start.end() - 1);
+        for (u32 proxy_index = 0; proxy_index < spatial.proxies.size(); ++proxy_index)
+        {
+            const SpatialProxy& proxy = spatial.proxies[proxy_index];
+            if (proxy.large)
+            {
+                spatial.large.push_back(proxy_index);
+                continue;
+            }
+            spatial.sorted[cursor[spatial_bucket(proxy.cell)]++] = proxy_index;
+        }
+
+        spatial.layout_dirty = false;
+    }
+
+    template<typename Func>
+    static void spatial_visit_cell(i32 x, i32 y, Func&& fn)
+    {
+        u64 cell   = spatial_cell_key(x, y);
+        u32 bucket = spatial_bucket(cell);
+        
+        for (u32 i = spatial.bucket_start[bucket]; i < spatial.bucket_start[bucket + 1]; ++i)
+        {
+            const SpatialProxy& proxy = spatial.proxies[spatial.sorted[i]];
+            if (proxy.cell == cell)
+            {
+                fn(proxy);
+            }
+        }
+    }
+
+    static void spatial_insert(Entity entity, const Bounds2D& bounds)
+    {
+        u32 index = entity_index(entity);
+        if (spatial.proxy_of.size() <= index)
+        {
+            spatial.proxy_of.resize(index + 1, U32_MAX);
+        }
+
+        spatial.extent.min = { std::min(spatial.extent.min.x, bounds.min.x), std::min(spatial.extent.min.y, bounds.min.y) };
+        spatial.extent.max = { std::max(spatial.extent.max.x, bounds.max.x), std::max(spatial.extent.max.y, bounds.max.y) };
+
+        u32 proxy_index = spatial.proxy_of[index];
+        if (proxy_index == U32_MAX)
+        {
+            spatial.proxy_of[index] = (u32) spatial.proxies.size();
+            
+            SpatialProxy& proxy = spatial.proxies.emplace_back();
+            proxy.entity = entity;
+            proxy.bounds = bounds;
+            spatial_place(proxy);
+            spatial.layout_dirty = true;
+            return;
+        }
+
+        SpatialProxy& proxy = spatial.proxies[proxy_index];
+        bool large = proxy.large;
+        u64  cell  = proxy.cell;
+        
+        proxy.bounds = bounds;
+        spatial_place(proxy);
+        spatial.layout_dirty |= proxy.large != large || proxy.cell != cell;
+    }
+
+    static void spatial_remove(Entity entity)
+    {
+        u32 index = entity_index(entity);
+        if (index >= spatial.proxy_of.size() || spatial.proxy_of[index] == U32_MAX)
+        {
+            return;
+        }
+
+        u32 proxy_index = spatial.proxy_of[index];
+        spatial.proxy_of[index] = U32_MAX;
+
+        if (proxy_index != spatial.proxies.size() - 1)
+        {
+            spatial.proxies[proxy_index] = spatial.proxies.back();
+            spatial.proxy_of[entity_index(spatial.proxies[proxy_index].entity)] = proxy_index;
+        }
+        spatial.proxies.pop_back();
+        spatial.layout_dirty = true;
+    }
+
+    static void spatial_refresh(Entity entity, const WorldTransform& world_transform)
+    {
+        spatial_insert(entity, spatial_world_bounds(world_transform.matrix, spatial_local_bounds(entity)));
+    }
+
+    static void component_added(Type* type, Entity entity)
+    {
+        if (spatial_is_shape(type))
+        {
+            spatial.pending.push_back(entity);
+        }
+    }
+
+    static void component_removed(Type* type, Entity entity)
+    {
+        if (type == GetType<WorldTransform>())
+        {
+            spatial_remove(entity);
+        }
+        else if (spatial_is_shape(type))
+        {
+            spatial.pending.push_back(entity);
+        }
+    }
+
+    static ListenerAction on_component_added(const ComponentAddedArgs& args)
+    {
+        component_added(args.type, args.entity);
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_component_removed(const ComponentRemovedArgs& args)
+    {
+        component_removed(args.type, args.entity);
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_components_added(const ComponentsAddedArgs& args)
+    {
+        for (Entity entity : args.entities)
+        {
+            component_added(args.type, entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_components_removed(const ComponentsRemovedArgs& args)
+    {
+        for (Entity entity : args.entities)
+        {
+            component_removed(args.type, entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_registry_restored()
+    {
+        spatial.full_scan = true;
+        return ListenerAction::StayListening;
+    }
+
+    void spatial_update()
+    {
+        if (spatial.full_scan)
+        {
+            f32 cell_size = spatial.cell_size;
+            spatial = {};
+            spatial.cell_size = cell_size;
+            spatial.full_scan = false;
+        }
+
+        for (Entity entity : spatial.pending)
+        {
+            if (IsEntityValid(entity) && entity_has<WorldTransform>(entity))
+            {
+                spatial_refresh(entity, entity_get<const WorldTransform>(entity));
+            }
+        }
+        spatial.pending.clear();
+
+        u32 since = spatial.since;
+        spatial.since = entity_advance_change_tick();
+
+        entity_view_each(entity_view<const WorldTransform>(changed<WorldTransform>(since)), spatial_refresh);
+        entity_view_each(entity_view<const WorldTransform, const Sprite>(changed<Sprite>(since)), [](Entity entity, const WorldTransform& world_transform, const Sprite&) {
+            spatial_refresh(entity, world_transform);
+        });
+        entity_view_each(entity_view<const WorldTransform, const Circle>(changed<Circle>(since)), [](Entity entity, const WorldTransform& world_transform, const Circle&) {
+            spatial_refresh(entity, world_transform);
+        });
+        entity_view_each(entity_view<const WorldTransform, const Line2D>(changed<Line2D>(since)), [](Entity entity, const WorldTransform& world_transform, const Line2D&) {
+            spatial_refresh(entity, world_transform);
+        });
+
+        spatial_layout();
+    }
+
+    void spatial_set_cell_size(f32 cell_size)
+    {
+        NIT_CHECK_MSG(cell_size > F32_EPSILON, "Invalid cell size!");
+        spatial.cell_size = cell_size;
+
+        for (SpatialProxy& proxy : spatial.proxies)
+        {
+            spatial_place(proxy);
+        }
+        spatial.layout_dirty = true;
+    }
+
+    bool spatial_contains(Entity entity)
+    {
+        u32 index = entity_index(entity);
+        return index < spatial.proxy_of.size() && spatial.proxy_of[index] != U32_MAX;
+    }
+
+    // Matches the quads filled in primitives_2d, sprites never leave the unit quad.
+    Bounds2D spatial_local_bounds(Entity entity)
+    {
+        Bounds2D bounds;
+
+        auto merge = [&bounds](const Vector2& min, const Vector2& max) {
+            bounds.min = { std::min(bounds.min.x, min.x), std::min(bounds.min.y, min.y) };
+            bounds.max = { std::max(bounds.max.x, max.x), std::max(bounds.max.y, max.y) };
+        };
+
+        if (entity_has<Sprite>(entity))
+        {
+            merge({ -.5f, -.5f }, { .5f, .5f });
+        }
+
+        if (entity_has<Circle>(entity))
+        {
+            f32 radius = entity_get<const Circle>(entity).radius;
+            merge({ -radius, -radius }, { radius, radius });
+        }
+
+        if (entity_has<Line2D>(entity))
+        {
+            const Line2D& line = entity_get<const Line2D>(entity);
+            f32 half_thickness = line.thickness * .5f;
+            merge({ std::min(line.start.x, line.end.x) - half_thickness, std::min(line.start.y, line.end.y) - half_thickness }
+                , { std::max(line.start.x, line.end.x) + half_thickness, std::max(line.start.y, line.end.y) + half_thickness });
+        }
+
+        return bounds;
+    }
+
+    Bounds2D spatial_world_bounds(const Matrix4& world_matrix, const Bounds2D& local_bounds)
+    {
+        const auto& m = world_matrix.m;
+        Vector2 center = (local_bounds.min + local_bounds.max) * .5f;
+        Vector2 half   = (local_bounds.max - local_bounds.min) * .5f;
+        
+        Vector2 world_center = { m[0][0] * center.x + m[1][0] * center.y + m[3][0], m[0][1] * center.x + m[1][1] * center.y + m[3][1] };
+        Vector2 world_half   = { Abs(m[0][0]) * half.x + Abs(m[1][0]) * half.y, Abs(m[0][1]) * half.x + Abs(m[1][1]) * half.y };
+        return { world_center - world_half, world_center + world_half };
+    }
+
+    bool spatial_overlaps(const Bounds2D& a, const Bounds2D& b)
+    {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x && a.min.y <= b.max.y && b.min.y <= a.max.y;
+    }
+
+    // Calls fn with every proxy that may overlap the region.
+    template<typename Func>
+    static void spatial_visit(const Bounds2D& region, Func&& fn)
+    {
+        spatial_layout();
+        
+        for (u32 proxy_index : spatial.large)
+        {
+            fn(spatial.proxies[proxy_index]);
+        }
+
+        f32 loose = spatial.cell_size * .5f;
+        i32 min_x = spatial_cell_coord(region.min.x - loose);
+        i32 min_y = spatial_cell_coord(region.min.y - loose);
+        i32 max_x = spatial_cell_coord(region.max.x + loose);
+        i32 max_y = spatial_cell_coord(region.max.y + loose);
+
+        // Regions covering more cells than there are proxies walk the proxies instead.
+        if ((u64) (max_x - min_x + 1) * (u64) (max_y - min_y + 1) > spatial.sorted.size())
+        {
+            for (u32 proxy_index : spatial.sorted)
+            {
+                fn(spatial.proxies[proxy_index]);
+            }
+            return;
+        }
+
+        for (i32 x = min_x; x <= max_x; ++x)
+        {
+            for (i32 y = min_y; y <= max_y; ++y)
+            {
+                spatial_visit_cell(x, y, fn);
+            }
+        }
+    }
+
+    void spatial_query_aabb(Array<Entity>& entities, const Vector2& min, const Vector2& max)
+    {
+        Bounds2D region = { min, max };
+        spatial_visit(region, [&](const SpatialProxy& proxy) {
+            if (spatial_overlaps(proxy.bounds, region))
+            {
+                entities.push_back(proxy.entity);
+            }
+        });
+    }
+
+    void spatial_query_radius(Array<Entity>& entities, const Vector2& center, f32 radius)
+    {
+        Bounds2D region = { { center.x - radius, center.y - radius }, { center.x + radius, center.y + radius } };
+        spatial_visit(region, [&](const SpatialProxy& proxy) {
+            Vector2 closest = { std::clamp(center.x, proxy.bounds.min.x, proxy.bounds.max.x), std::clamp(center.y, proxy.bounds.min.y, proxy.bounds.max.y) };
+            Vector2 delta   = closest - center;
+            if (Dot(delta, delta) <= radius * radius)
+            {
+                entities.push_back(proxy.entity);
+            }
+        });
+    }
+
+    static bool spatial_ray_bounds(const Vector2& origin, const Vector2& direction, const Bounds2D& bounds, f32& distance)
+    {
+        f32 enter = 0.f, exit = F32_MAX;
+        const f32 origins[]    = { origin.x, origin.y };
+        const f32 directions[] = { direction.x, direction.y };
+        const f32 mins[]       = { bounds.min.x, bounds.min.y };
+        const f32 maxs[]       = { bounds.max.x, bounds.max.y };
+
+        for (u32 axis = 0; axis < 2; ++axis)
+        {
+            if (Abs(directions[axis]) <= F32_EPSILON)
+            {
+                if (origins[axis] < mins[axis] || origins[axis] > maxs[axis])
+                {
+                    return false;
+                }
+                continue;
+            }
+
+            f32 near_t = (mins[axis] - origins[axis]) / directions[axis];
+            f32 far_t  = (maxs[axis] - origins[axis]) / directions[axis];
+            enter = std::max(enter, std::min(near_t, far_t));
+            exit  = std::min(exit, std::max(near_t, far_t));
+
+            if (enter > exit)
+            {
+                return false;
+            }
+        }
+
+        distance = enter;
+        return true;
+    }
+
+    // Walks the cells along the ray in order. A proxy crossed at some distance has its center at most one cell away
+    // from the cell of the crossing point, so once a cell is entered further than the closest hit the walk stops.
+    Entity spatial_raycast_2d(const Vector2& origin, const Vector2& direction, f32 max_distance, f32* hit_distance)
+    {
+        f32 length = Magnitude(direction);
+        if (length <= F32_EPSILON)
+        {
+            return NULL_ENTITY;
+        }
+
+        Vector2 ray_direction = direction / length;
+        Entity  closest       = NULL_ENTITY;
+        f32     closest_t     = max_distance;
+
+        auto test = [&](const SpatialProxy& proxy) {
+            f32 t;
+            if (spatial_ray_bounds(origin, ray_direction, proxy.bounds, t) && t <= closest_t)
+            {
+                closest   = proxy.entity;
+                closest_t = t;
+            }
+        };
+
+        spatial_layout();
+        
+        for (u32 proxy_index : spatial.large)
+        {
+            test(spatial.proxies[proxy_index]);
+        }
+
+        Bounds2D area = { { spatial.extent.min.x - spatial.cell_size, spatial.extent.min.y - spatial.cell_size }
+                        , { spatial.extent.max.x + spatial.cell_size, spatial.extent.max.y + spatial.cell_size } };
+        f32 start_t = 0.f;
+        bool crosses_cells = !spatial.sorted.empty() && spatial_ray_bounds(origin, ray_direction, area, start_t);
+
+        Vector2 start = origin + ray_direction * start_t;
+        i32 x = spatial_cell_coord(start.x);
+        i32 y = spatial_cell_coord(start.y);
+        i32 step_x = ray_direction.x >= 0.f ? 1 : -1;
+        i32 step_y = ray_direction.y >= 0.f ? 1 : -1;
+
+        f32 delta_x = Abs(ray_direction.x) > F32_EPSILON ? spatial.cell_size / Abs(ray_direction.x) : F32_MAX;
+        f32 delta_y = Abs(ray_direction.y) > F32_EPSILON ? spatial.cell_size / Abs(ray_direction.y) : F32_MAX;
+        f32 next_x  = Abs(ray_direction.x) > F32_EPSILON ? start_t + ((x + (step_x > 0)) * spatial.cell_size - start.x) / ray_direction.x : F32_MAX;
+        f32 next_y  = Abs(ray_direction.y) > F32_EPSILON ? start_t + ((y + (step_y > 0)) * spatial.cell_size - start.y) / ray_direction.y : F32_MAX;
+
+        for (f32 cell_t = start_t; crosses_cells && cell_t <= closest_t;)
+        {
+            Vector2 point = origin + ray_direction * cell_t;
+            if (point.x < area.min.x || point.x > area.max.x || point.y < area.min.y || point.y > area.max.y)
+            {
+                break;
+            }
+
+            for (i32 neighbour_x = x - 1; neighbour_x <= x + 1; ++neighbour_x)
+            {
+                for (i32 neighbour_y = y - 1; neighbour_y <= y + 1; ++neighbour_y)
+                {
+                    spatial_visit_cell(neighbour_x, neighbour_y, test);
+                }
+            }
+
+            if (next_x < next_y)
+            {
+                cell_t  = next_x;
+                next_x += delta_x;
+                x      += step_x;
+            }
+            else
+            {
+                cell_t  = next_y;
+                next_y += delta_y;
+                y      += step_y;
+            }
+        }
+
+        if (hit_distance && closest != NULL_ENTITY)
+        {
+            *hit_distance = closest_t;
+        }
+        return closest;
+    }
+}
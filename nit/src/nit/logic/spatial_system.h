@@ -0,0 +1,56 @@
+﻿#pragma once
+#include "entity.h"
+
+#define NIT_SPATIAL_DEFAULT_CELL_SIZE 4.f
+
+namespace nit
+{
+    struct Bounds2D
+    {
+        Vector2 min = V2_ZERO;
+        Vector2 max = V2_ZERO;
+    };
+    
+    struct SpatialProxy
+    {
+        Entity   entity = NULL_ENTITY;
+        Bounds2D bounds;
+        u64      cell   = 0;
+        bool     large  = false;
+    };
+
+    // Loose hashed grid over the world bounds of the entities with a WorldTransform. Each proxy belongs to the cell
+    // of its center, so queries look half a cell further and proxies bigger than a cell are tested apart.
+    // Cells are hashed into buckets laid out back to back, the layout is rebuilt with a counting sort only when a
+    // proxy changes cell, moving inside a cell just updates the bounds.
+    // Bounds come from Sprite, Circle and Line2D, other entities are points.
+    struct SpatialIndex
+    {
+        f32                 cell_size     = NIT_SPATIAL_DEFAULT_CELL_SIZE;
+        Array<SpatialProxy> proxies;
+        Array<u32>          proxy_of;      // Entity index to proxy, U32_MAX if not indexed
+        Array<u32>          bucket_start;  // Proxies of bucket i are sorted[bucket_start[i]..bucket_start[i + 1]]
+        Array<u32>          sorted;
+        Array<u32>          large;
+        Array<Entity>       pending;       // Shape added or removed
+        Bounds2D            extent;        // Covers every proxy ever inserted, limits raycasts
+        u32                 since         = 0;
+        bool                layout_dirty  = true;
+        bool                full_scan     = true;
+    };
+
+    void     register_spatial_system();
+    void     spatial_update();
+    void     spatial_set_cell_size(f32 cell_size);
+    bool     spatial_contains(Entity entity);
+    
+    Bounds2D spatial_local_bounds(Entity entity);
+    Bounds2D spatial_world_bounds(const Matrix4& world_matrix, const Bounds2D& local_bounds);
+    bool     spatial_overlaps(const Bounds2D& a, const Bounds2D& b);
+
+    void     spatial_query_aabb(Array<Entity>& entities, const Vector2& min, const Vector2& max);
+    void     spatial_query_radius(Array<Entity>& entities, const Vector2& center, f32 radius);
+    
+    // Closest entity whose bounds the ray crosses within max_distance, direction doesn't need to be normalized.
+    Entity   spatial_raycast_2d(const Vector2& origin, const Vector2& direction, f32 max_distance, f32* hit_distance = nullptr);
+}
@@ -0,0 +1,333 @@
+﻿#include "transform_system.h"
+#include "nit/core/engine.h"
+
+namespace nit
+{
+    static TransformHierarchy hierarchy;
+    
+    ListenerAction transform_start();
+    ListenerAction transform_end();
+    ListenerAction transform_pre_draw();
+    
+    static ListenerAction on_component_added(const ComponentAddedArgs& args);
+    static ListenerAction on_component_removed(const ComponentRemovedArgs& args);
+    static ListenerAction on_components_added(const ComponentsAddedArgs& args);
+    static ListenerAction on_components_removed(const ComponentsRemovedArgs& args);
+    static ListenerAction on_registry_restored();
+
+    void register_transform_system()
+    {
+        RegisterComponentType<Parent>();
+        RegisterComponentType<Children>();
+        RegisterComponentType<WorldTransform>();
+        
+        engine_event(Stage::Start)   += EngineListener::create(transform_start);
+        engine_event(Stage::End)     += EngineListener::create(transform_end);
+        engine_event(Stage::PreDraw) += EngineListener::create(transform_pre_draw);
+    }
+
+    ListenerAction transform_start()
+    {
+        entity_registry_get_instance()->component_added_event    += ComponentAddedListener::create(on_component_added);
+        entity_registry_get_instance()->component_removed_event  += ComponentRemovedListener::create(on_component_removed);
+        entity_registry_get_instance()->components_added_event   += ComponentsAddedListener::create(on_components_added);
+        entity_registry_get_instance()->components_removed_event += ComponentsRemovedListener::create(on_components_removed);
+        entity_registry_get_instance()->restored_event           += Listener<>::create(on_registry_restored);
+        transform_hierarchy_invalidate();
+        return ListenerAction::StayListening;
+    }
+
+    ListenerAction transform_end()
+    {
+        entity_registry_get_instance()->component_added_event    -= ComponentAddedListener::create(on_component_added);
+        entity_registry_get_instance()->component_removed_event  -= ComponentRemovedListener::create(on_component_removed);
+        entity_registry_get_instance()->components_added_event   -= ComponentsAddedListener::create(on_components_added);
+        entity_registry_get_instance()->components_removed_event -= ComponentsRemovedListener::create(on_components_removed);
+        entity_registry_get_instance()->restored_event           -= Listener<>::create(on_registry_restored);
+        hierarchy = {};
+        return ListenerAction::StayListening;
+    }
+
+    ListenerAction transform_pre_draw()
+    {
+        transform_propagate();
+        return ListenerAction::StayListening;
+    }
+
+    // Listeners can't add or remove components, the structural work is left for transform_propagate.
+    static void component_added(Type* type, Entity entity)
+    {
+        if (type == GetType<Transform>())
+        {
+            hierarchy.pending.push_back(entity);
+        }
+        else if (type == GetType<Parent>() || type == GetType<Children>())
+        {
+            hierarchy.rebuild = true;
+        }
+    }
+
+    static void component_removed(Type* type, Entity entity)
+    {
+        if (type == GetType<Parent>())
+        {
+            Entity parent = entity_get<const Parent>(entity).entity;
+            
+            if (IsEntityValid(parent) && entity_has<Children>(parent))
+            {
+                Array<Entity>& siblings = entity_get<Children>(parent).entities;
+                siblings.erase(std::remove(siblings.begin(), siblings.end(), entity), siblings.end());
+            }
+            hierarchy.rebuild = true;
+        }
+        else if (type == GetType<Children>())
+        {
+            const Array<Entity>& children = entity_get<const Children>(entity).entities;
+            hierarchy.orphans.insert(hierarchy.orphans.end(), children.begin(), children.end());
+            hierarchy.rebuild = true;
+        }
+        else if (type == GetType<Transform>() || type == GetType<WorldTransform>())
+        {
+            hierarchy.rebuild |= entity_has<Parent>(entity) || entity_has<Children>(entity);
+        }
+    }
+
+    static ListenerAction on_component_added(const ComponentAddedArgs& args)
+    {
+        component_added(args.type, args.entity);
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_component_removed(const ComponentRemovedArgs& args)
+    {
+        component_removed(args.type, args.entity);
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_components_added(const ComponentsAddedArgs& args)
+    {
+        for (Entity entity : args.entities)
+        {
+            component_added(args.type, entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_components_removed(const ComponentsRemovedArgs& args)
+    {
+        for (Entity entity : args.entities)
+        {
+            component_removed(args.type, entity);
+        }
+        return ListenerAction::StayListening;
+    }
+
+    static ListenerAction on_registry_restored()
+    {
+        transform_hierarchy_invalidate();
+        return ListenerAction::StayListening;
+    }
+
+    static bool transform_in_hierarchy(Entity entity)
+    {
+        return IsEntityValid(entity) && entity_has<Transform>(entity) && entity_has<WorldTransform>(entity);
+    }
+
+    static void transform_hierarchy_push_root(Array<TransformHierarchy::Node>& stack, Entity root)
+    {
+        if (transform_in_hierarchy(transform_get_parent(root)) || !entity_has<Transform>(root))
+        {
+            return;
+        }
+        
+        hierarchy.roots.push_back((u32) hierarchy.nodes.size());
+        stack.push_back({ root, U32_MAX });
+
+        while (!stack.empty())
+        {
+            TransformHierarchy::Node node = stack.back();
+            stack.pop_back();
+
+            u32 node_index = (u32) hierarchy.nodes.size();
+            hierarchy.nodes.push_back(node);
+
+            if (!entity_has<Children>(node.entity))
+            {
+                continue;
+            }
+
+            const Array<Entity>& children = entity_get<const Children>(node.entity).entities;
+            for (auto it = children.rbegin(); it != children.rend(); ++it)
+            {
+                if (transform_in_hierarchy(*it))
+                {
+                    stack.push_back({ *it, node_index });
+                }
+            }
+        }
+    }
+
+    // Depth first from every entity with a parent or children whose own parent isn't part of the hierarchy.
+    static void transform_hierarchy_rebuild()
+    {
+        hierarchy.nodes.clear();
+        hierarchy.roots.clear();
+        
+        Array<TransformHierarchy::Node> stack;
+        
+        for (Entity root : entity_view<const Children, const WorldTransform>())
+        {
+            transform_hierarchy_push_root(stack, root);
+        }
+        
+        for (Entity root : entity_view<const Parent, const WorldTransform>(exclude<Children>))
+        {
+            transform_hierarchy_push_root(stack, root);
+        }
+        
+        hierarchy.rebuild = false;
+    }
+
+    void transform_propagate()
+    {
+        if (hierarchy.full_scan)
+        {
+            for (Entity entity : entity_view<const Transform>(exclude<WorldTransform>))
+            {
+                hierarchy.pending.push_back(entity);
+            }
+            hierarchy.full_scan = false;
+        }
+
+        // Children of destroyed entities become roots.
+        for (Entity orphan : hierarchy.orphans)
+        {
+            if (IsEntityValid(orphan) && entity_has<Parent>(orphan) && !IsEntityValid(entity_get<const Parent>(orphan).entity))
+            {
+                entity_remove<Parent>(orphan);
+                if (entity_has<Transform>(orphan))
+                {
+                    entity_patch<Transform>(orphan);
+                }
+            }
+        }
+        hierarchy.orphans.clear();
+
+        for (Entity entity : hierarchy.pending)
+        {
+            if (IsEntityValid(entity) && entity_has<Transform>(entity) && !entity_has<WorldTransform>(entity))
+            {
+                entity_add<WorldTransform>(entity, { ToMatrix4(entity_get<const Transform>(entity)) });
+                hierarchy.rebuild |= entity_has<Parent>(entity) || entity_has<Children>(entity);
+            }
+        }
+        hierarchy.pending.clear();
+
+        u32 since = hierarchy.since;
+        hierarchy.since = entity_advance_change_tick();
+
+        auto flat_view = entity_view<const Transform, WorldTransform>(exclude<Parent, Children>, changed<Transform>(since));
+        entity_view_each(flat_view, [](Entity, const Transform& transform, WorldTransform& world_transform) {
+            world_transform.matrix = ToMatrix4(transform);
+        });
+
+        bool rebuilt = hierarchy.rebuild;
+        if (rebuilt)
+        {
+            transform_hierarchy_rebuild();
+        }
+
+        hierarchy.dirty.resize(hierarchy.nodes.size());
+
+        // Root subtrees don't depend on each other, the sweep could be split by hierarchy.roots.
+        for (u32 i = 0; i < hierarchy.nodes.size(); ++i)
+        {
+            const TransformHierarchy::Node& node = hierarchy.nodes[i];
+            bool parent_dirty = node.parent != U32_MAX && hierarchy.dirty[node.parent];
+            hierarchy.dirty[i] = rebuilt || parent_dirty || entity_changed<Transform>(node.entity, since);
+
+            if (!hierarchy.dirty[i])
+            {
+                continue;
+            }
+
+            Matrix4 local = ToMatrix4(entity_get<const Transform>(node.entity));
+            entity_patch<WorldTransform>(node.entity).matrix = node.parent != U32_MAX
+                ? entity_get<const WorldTransform>(hierarchy.nodes[node.parent].entity).matrix * local
+                : local;
+        }
+    }
+
+    void transform_hierarchy_invalidate()
+    {
+        hierarchy.rebuild   = true;
+        hierarchy.full_scan = true;
+        hierarchy.since     = 0;
+    }
+
+    void transform_set_parent(Entity child, Entity parent)
+    {
+        NIT_CHECK_MSG(IsEntityValid(child), "Invalid entity!");
+        NIT_CHECK_MSG(parent == NULL_ENTITY || IsEntityValid(parent), "Invalid parent!");
+
+        for (Entity ancestor = parent; ancestor != NULL_ENTITY; ancestor = transform_get_parent(ancestor))
+        {
+            NIT_CHECK_MSG(ancestor != child, "Parenting would create a cycle!");
+        }
+
+        Entity old_parent = transform_get_parent(child);
+        if (old_parent == parent)
+        {
+            return;
+        }
+
+        if (IsEntityValid(old_parent) && entity_has<Children>(old_parent))
+        {
+            Array<Entity>& siblings = entity_get<Children>(old_parent).entities;
+            siblings.erase(std::remove(siblings.begin(), siblings.end(), child), siblings.end());
+            
+            if (siblings.empty())
+            {
+                entity_remove<Children>(old_parent);
+            }
+        }
+
+        if (parent == NULL_ENTITY)
+        {
+            entity_remove<Parent>(child);
+        }
+        else
+        {
+            if (entity_has<Parent>(child))
+            {
+                entity_get<Parent>(child).entity = parent;
+            }
+            else
+            {
+                entity_add<Parent>(child, { parent });
+            }
+
+            if (!entity_has<Children>(parent))
+            {
+                entity_add<Children>(parent);
+            }
+            entity_get<Children>(parent).entities.push_back(child);
+        }
+
+        if (entity_has<Transform>(child))
+        {
+            entity_patch<Transform>(child);
+        }
+        hierarchy.rebuild = true;
+    }
+
+    Entity transform_get_parent(Entity entity)
+    {
+        return IsEntityValid(entity) && entity_has<Parent>(entity) ? entity_get<const Parent>(entity).entity : NULL_ENTITY;
+    }
+
+    Matrix4 transform_world_matrix(Entity entity)
+    {
+        return entity_has<WorldTransform>(entity) ? entity_get<const WorldTransform>(entity).matrix : ToMatrix4(entity_get<const Transform>(entity));
+    }
+}
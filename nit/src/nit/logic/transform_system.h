@@ -0,0 +1,53 @@
+﻿#pragma once
+#include "entity.h"
+#include "components.h"
+
+namespace nit
+{
+    struct Parent
+    {
+        Entity entity = NULL_ENTITY;
+    };
+
+    struct Children
+    {
+        Array<Entity> entities;
+    };
+
+    // Cached local to world matrix, refreshed by transform_propagate. Every entity with a Transform gets one.
+    struct WorldTransform
+    {
+        Matrix4 matrix;
+    };
+
+    // Entities without parent nor children are refreshed in a flat pass. The rest are kept in depth first order,
+    // parents before their children and each root subtree contiguous, so one linear sweep recomputes the subtrees
+    // whose Transform changed since the last propagation.
+    struct TransformHierarchy
+    {
+        struct Node
+        {
+            Entity entity = NULL_ENTITY;
+            u32    parent = U32_MAX; // Index in nodes, U32_MAX for roots
+        };
+
+        Array<Node>   nodes;
+        Array<u32>    roots;       // First node of each root subtree
+        Array<u8>     dirty;
+        Array<Entity> pending;     // Got a Transform, waiting for their WorldTransform
+        Array<Entity> orphans;     // Their parent was destroyed
+        u32           since      = 0;
+        bool          rebuild    = true;
+        bool          full_scan  = true;
+    };
+
+    void    register_transform_system();
+    void    transform_propagate();
+    void    transform_hierarchy_invalidate();
+    
+    void    transform_set_parent(Entity child, Entity parent);
+    Entity  transform_get_parent(Entity entity);
+    
+    // The cached world matrix if propagated already, otherwise the local one.
+    Matrix4 transform_world_matrix(Entity entity);
+}
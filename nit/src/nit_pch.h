@@ -19,6 +19,12 @@
 #include <bitset>
 #include <queue>
 #include <set>
+#include <span>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <deque>
 #include <yaml-cpp/yaml.h>
 
 #include "nit/core/base.h"
@@ -29,6 +35,7 @@
 #include "nit/core/type.h"
 #include "nit/core/sparse_set.h"
 #include "nit/core/pool.h"
+#include "nit/core/jobs.h"
 
 #ifdef NIT_PLATFORM_LINUX
 #include <linux/string.h>
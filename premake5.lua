@@ -142,6 +142,51 @@ project "app"
     filter "system:windows"
         systemversion "latest"
 
+project "bench"
+
+    kind          "ConsoleApp"
+    language      "C++"
+    cppdialect    "C++20"
+    location      "bench"
+    targetdir     (binariesdir)
+    objdir        (intermediatesdir)
+    pchheader     "bench_pch.h"
+    pchsource     "bench/src/bench_pch.cpp"
+    forceincludes { "bench_pch.h" }
+
+    includedirs 
+    {
+        "nit/src",
+        "bench/src",
+        "3rd/imgui/src",
+        "3rd/yaml/include"
+    }
+    
+    links
+    {
+        "nit"
+    }
+
+    files { "bench/src/**.h", "bench/src/**.cpp" }
+
+    filter "configurations:Debug"
+        symbols "On"
+        runtime "Debug"
+        defines "NIT_DEBUG"
+
+    filter "configurations:Release"
+        optimize "On"
+        runtime "Release"
+        defines "NIT_RELEASE"
+
+    filter "configurations:Dist"
+		runtime "Release"
+		optimize "On"
+        defines "NIT_DIST"
+
+    filter "system:windows"
+        systemversion "latest"
+
 group "3rd"
 
 project "glfw"